@@ -1,43 +1,293 @@
 #include "MultiWindowShared.h"
+#include "MultiWindowTrace.h"
+#include "MultiWindowHandles.h"
+#include "MultiWindowExport.h"
 #include "IUnityInterface.h"
 
 #include <d3d11.h> 
 #include <d3d10_1.h>
+#include <d3dcompiler.h>
+#include "IUnityGraphics.h"
 #include "IUnityGraphicsD3D11.h"
 
 #include <dwmapi.h>
 #include <windows.h>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <functional>
 #include <string>
 
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "dxgi.lib")
 #pragma comment(lib, "dwmapi.lib")
+#pragma comment(lib, "d3dcompiler.lib")
 
 // --- 전역 변수 ---
-static ID3D11Device* g_UnityDevice = nullptr;
-static ID3D10Multithread* g_Multithread = nullptr;
+static IUnityInterfaces* g_UnityInterfaces = nullptr;
+static IUnityGraphics* g_Graphics = nullptr;
+static std::atomic<ID3D11Device*> g_UnityDevice{ nullptr };
+static std::atomic<ID3D10Multithread*> g_Multithread{ nullptr }; // 프레젠터는 시작할 때 자기 참조를 따로 잡음
+static std::atomic<int> g_ActivePresenters{ 0 }; // 디바이스 종료 시 프레젠터가 다 끝날 때까지 대기용
+static int g_RenderEventID = 0; // ReserveEventIDRange로 받은 값
+static std::mutex g_RenderEventMutex; // StopSubWindow가 진행 중인 렌더 이벤트를 기다리는 용도
+static std::atomic<int> g_NextWindowId{ 0 }; // 스레드 이름용 (mw-present-<id>)
+static const UINT_PTR SIZE_MOVE_TIMER_ID = 1; // 드래그 중 모달 루프 안에서 계속 Present 하기 위한 타이머
+static const ULONGLONG RESIZE_SETTLE_MS = 250; // 크기가 이만큼 안 바뀌면 드래그가 멈춘 것으로 봄
+static const long long FRAME_INTERVAL_NS = 16000000LL; // 입력으로만 깨어나도 이 간격마다는 명령 처리와 Present를 함
+static const long long RENDER_EVENT_TIMEOUT_NS = 500000000LL; // 렌더 이벤트가 이만큼 없으면 프레젠터가 직접 복사하는 모드로 돌아감
+
+// 아틀라스 영역의 텍셀 범위
+static D3D11_BOX SourceBox(ID3D11Texture2D* src, const SourceRect& rect) {
+    D3D11_TEXTURE2D_DESC srcDesc;
+    src->GetDesc(&srcDesc);
+    auto clamp01 = [](float f) { return f < 0.0f ? 0.0f : f > 1.0f ? 1.0f : f; };
+
+    D3D11_BOX box = {};
+    box.left = (UINT)(clamp01(rect.u0) * srcDesc.Width); box.right = (UINT)(clamp01(rect.u1) * srcDesc.Width);
+    box.top = (UINT)(clamp01(rect.v0) * srcDesc.Height); box.bottom = (UINT)(clamp01(rect.v1) * srcDesc.Height);
+    box.front = 0; box.back = 1;
+    return box;
+}
+
+// 셰이더로 그릴 수 없는 원본용 대체 경로: 영역을 백버퍼 왼쪽 위로 복사 (늘리지 못하고 flipY도 무시됨)
+static void CopySourceRegion(ID3D11DeviceContext* context, ID3D11Texture2D* dst, ID3D11Texture2D* src, const SourceRect& rect) {
+    D3D11_TEXTURE2D_DESC dstDesc;
+    dst->GetDesc(&dstDesc);
+    D3D11_BOX box = SourceBox(src, rect);
+    if (box.right > box.left + dstDesc.Width) box.right = box.left + dstDesc.Width;
+    if (box.bottom > box.top + dstDesc.Height) box.bottom = box.top + dstDesc.Height;
+    if (box.right <= box.left || box.bottom <= box.top) return;
+    context->CopySubresourceRegion(dst, 0, 0, 0, 0, src, 0, &box);
+}
+
+static const char g_BlitShader[] =
+    "cbuffer Rect : register(b0) { float4 uvRect; float4 options; };\n" // uvRect = u0 v0 u1 v1 (flipY면 v0, v1을 바꿔서 넣음), options.x = sRGB 다시 인코딩
+    "Texture2D tex : register(t0); SamplerState samp : register(s0);\n"
+    "void VS(uint id : SV_VertexID, out float4 pos : SV_Position, out float2 uv : TEXCOORD0) {\n"
+    "    float2 t = float2(id & 1, id >> 1);\n"
+    "    pos = float4(t.x * 2 - 1, 1 - t.y * 2, 0, 1);\n"
+    "    uv = lerp(uvRect.xy, uvRect.zw, t);\n"
+    "}\n"
+    "float4 PS(float4 pos : SV_Position, float2 uv : TEXCOORD0) : SV_Target {\n"
+    "    float4 c = tex.Sample(samp, uv);\n"
+    "    if (options.x > 0) c.rgb = c.rgb <= 0.0031308 ? c.rgb * 12.92 : 1.055 * pow(abs(c.rgb), 1.0 / 2.4) - 0.055;\n"
+    "    return c;\n"
+    "}\n";
+
+// 유니티 RenderTexture는 보통 TYPELESS라서 SRV 형식을 직접 정해야 함 (비트 그대로 읽도록 UNORM)
+// sRGB도 UNORM으로 읽어야 선형 변환 없이 UNORM 백버퍼에 그대로 들어감
+static DXGI_FORMAT ShaderViewFormat(DXGI_FORMAT format) {
+    switch (format) {
+    case DXGI_FORMAT_R8G8B8A8_TYPELESS: case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB: return DXGI_FORMAT_R8G8B8A8_UNORM;
+    case DXGI_FORMAT_B8G8R8A8_TYPELESS: case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB: return DXGI_FORMAT_B8G8R8A8_UNORM;
+    case DXGI_FORMAT_R10G10B10A2_TYPELESS: return DXGI_FORMAT_R10G10B10A2_UNORM;
+    case DXGI_FORMAT_R16G16B16A16_TYPELESS: return DXGI_FORMAT_R16G16B16A16_FLOAT;
+    default: return format;
+    }
+}
+
+// 아틀라스 영역을 백버퍼 전체에 늘려서 그림 (GL/Linux 백엔드의 쿼드와 같음)
+// 유니티와 같은 즉시 컨텍스트를 쓰므로 지연 컨텍스트에 기록한 뒤 ExecuteCommandList(..., TRUE)로 실행해서
+// 유니티의 파이프라인 상태를 건드리지 않음. 그릴 수 없는 원본(MSAA, SRV 불가)은 지우고 복사로 대체
+// 호출자가 backBufferMutex를 잡은 상태에서 호출 (프레젠터 스레드에서는 ID3D10Multithread도)
+struct D3D11Blitter {
+    ID3D11DeviceContext* deferred = nullptr;
+    ID3D11VertexShader* vs = nullptr; ID3D11PixelShader* ps = nullptr;
+    ID3D11SamplerState* sampler = nullptr; ID3D11Buffer* constants = nullptr;
+    ID3D11RenderTargetView* rtv = nullptr; ID3D11Texture2D* rtvTarget = nullptr;
+    ID3D11ShaderResourceView* srv = nullptr; ID3D11Texture2D* srvSource = nullptr; // SRV가 원본 참조를 잡고 있으므로 주소 재사용 걱정 없음
+    bool initFailed = false;
+    bool lastDrawScaled = false; // 마지막 Draw가 쿼드로 늘려 그렸는지 (복사 대체 경로면 false)
+    bool srvDecodesSrgb = false; // sRGB SRV로 읽는 중 (셰이더에서 다시 sRGB로 인코딩)
+
+    bool Init(ID3D11Device* device) {
+        if (deferred) return true;
+        if (initFailed) return false;
+        ID3DBlob* vsBlob = nullptr; ID3DBlob* psBlob = nullptr;
+        bool ok = SUCCEEDED(D3DCompile(g_BlitShader, sizeof(g_BlitShader) - 1, "MultiWindowBlit", NULL, NULL, "VS", "vs_4_0", 0, 0, &vsBlob, NULL))
+            && SUCCEEDED(D3DCompile(g_BlitShader, sizeof(g_BlitShader) - 1, "MultiWindowBlit", NULL, NULL, "PS", "ps_4_0", 0, 0, &psBlob, NULL))
+            && SUCCEEDED(device->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), NULL, &vs))
+            && SUCCEEDED(device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), NULL, &ps));
+        if (vsBlob) vsBlob->Release();
+        if (psBlob) psBlob->Release();
+
+        if (ok) {
+            D3D11_SAMPLER_DESC sd = {};
+            sd.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+            sd.AddressU = sd.AddressV = sd.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+            sd.MaxLOD = D3D11_FLOAT32_MAX;
+            D3D11_BUFFER_DESC bd = {};
+            bd.ByteWidth = 32; bd.Usage = D3D11_USAGE_DYNAMIC; bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER; bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+            ok = SUCCEEDED(device->CreateSamplerState(&sd, &sampler))
+                && SUCCEEDED(device->CreateBuffer(&bd, NULL, &constants))
+                && SUCCEEDED(device->CreateDeferredContext(0, &deferred));
+        }
+        if (!ok) { Release(); initFailed = true; } // 피처 레벨 9.x 등: 복사 경로만 사용
+        return ok;
+    }
+
+    void Draw(ID3D11Device* device, ID3D11DeviceContext* immediate, ID3D11Texture2D* dst, ID3D11Texture2D* src, const SourceRect& rect) {
+        if (dst != rtvTarget) {
+            ReleaseTarget();
+            if (SUCCEEDED(device->CreateRenderTargetView(dst, NULL, &rtv))) rtvTarget = dst;
+        }
+        if (src != srvSource || !srv) {
+            if (srv) { srv->Release(); srv = nullptr; }
+            srvSource = nullptr;
+            D3D11_TEXTURE2D_DESC desc; src->GetDesc(&desc);
+            if ((desc.BindFlags & D3D11_BIND_SHADER_RESOURCE) && desc.SampleDesc.Count == 1) {
+                D3D11_SHADER_RESOURCE_VIEW_DESC vd = {};
+                vd.Format = ShaderViewFormat(desc.Format); vd.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D; vd.Texture2D.MipLevels = 1;
+                srvDecodesSrgb = false;
+                if (FAILED(device->CreateShaderResourceView(src, &vd, &srv)) && vd.Format != desc.Format) {
+                    // TYPELESS가 아닌 sRGB 텍스처는 UNORM 뷰를 만들 수 없음 -> 원래 형식으로 읽고 셰이더에서 되돌림
+                    vd.Format = desc.Format;
+                    srvDecodesSrgb = SUCCEEDED(device->CreateShaderResourceView(src, &vd, &srv));
+                }
+                if (srv) srvSource = src;
+            }
+        }
+
+        if (!rtv || !srv || !Init(device)) {
+            if (rtv) { const float clear[4] = { 0, 0, 0, 0 }; immediate->ClearRenderTargetView(rtv, clear); } // 복사가 못 덮는 부분
+            CopySourceRegion(immediate, dst, src, rect);
+            lastDrawScaled = false;
+            return;
+        }
+
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        if (FAILED(deferred->Map(constants, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) return;
+        float* uv = (float*)mapped.pData;
+        uv[0] = rect.u0; uv[1] = rect.flipY ? rect.v1 : rect.v0; uv[2] = rect.u1; uv[3] = rect.flipY ? rect.v0 : rect.v1;
+        uv[4] = srvDecodesSrgb ? 1.0f : 0.0f; uv[5] = uv[6] = uv[7] = 0.0f;
+        deferred->Unmap(constants, 0);
+
+        D3D11_TEXTURE2D_DESC dd; dst->GetDesc(&dd);
+        D3D11_VIEWPORT vp = { 0.0f, 0.0f, (float)dd.Width, (float)dd.Height, 0.0f, 1.0f };
+        deferred->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        deferred->VSSetShader(vs, NULL, 0); deferred->VSSetConstantBuffers(0, 1, &constants);
+        deferred->PSSetShader(ps, NULL, 0); deferred->PSSetShaderResources(0, 1, &srv); deferred->PSSetSamplers(0, 1, &sampler);
+        deferred->RSSetViewports(1, &vp);
+        deferred->OMSetRenderTargets(1, &rtv, NULL);
+        deferred->Draw(4, 0);
+
+        ID3D11CommandList* list = nullptr;
+        if (SUCCEEDED(deferred->FinishCommandList(FALSE, &list))) {
+            immediate->ExecuteCommandList(list, TRUE); // TRUE = 실행 뒤 즉시 컨텍스트 상태 복원
+            list->Release();
+        }
+        lastDrawScaled = true;
+    }
+
+    // ResizeBuffers 전에 백버퍼 참조를 모두 놓아야 함
+    void ReleaseTarget() {
+        if (rtv) { rtv->Release(); rtv = nullptr; }
+        rtvTarget = nullptr;
+    }
+
+    void Release() {
+        ReleaseTarget();
+        if (srv) { srv->Release(); srv = nullptr; }
+        srvSource = nullptr;
+        if (deferred) { deferred->Release(); deferred = nullptr; }
+        if (vs) { vs->Release(); vs = nullptr; }
+        if (ps) { ps->Release(); ps = nullptr; }
+        if (sampler) { sampler->Release(); sampler = nullptr; }
+        if (constants) { constants->Release(); constants = nullptr; }
+    }
+};
 
 struct D3D11WindowContext {
     std::thread renderThread;
     std::mutex mutex;
     HANDLE hRenderEvent = NULL;
     bool isRunning = false;
+    int id = 0;
+    void* handle = nullptr; // 유니티에 넘긴 핸들 (콜백/트레이스에 사용)
 
     HWND hWnd = NULL;
     WindowCommand cmd;
-    ID3D11Texture2D* sharedTexture = nullptr;
+    std::atomic<ID3D11Texture2D*> sharedTexture{ nullptr };
+
+    // GetRenderEventFunc 모드: 유니티 렌더 스레드가 백버퍼로 복사하고 프레젠터는 Present만 함
+    // 첫 렌더 이벤트가 들어오면 켜지고, RENDER_EVENT_TIMEOUT_NS 동안 이벤트가 없거나 SetRenderEventMode(false)면 꺼짐
+    std::atomic<bool> renderEventMode{ false };
+    std::atomic<bool> renderEventAllowed{ true };
+    unsigned long long copySeq = 0; // 렌더 스레드가 백버퍼에 그린 횟수 (backBufferMutex로 보호)
+    std::atomic<long long> lastRenderEventNs{ 0 };
+    std::mutex backBufferMutex; // 렌더 스레드 복사 <-> 프레젠터의 백버퍼 수명, sourceRect, blitter
+    ID3D11Texture2D* backBuffer = nullptr;
+    D3D11Blitter blitter;
+    SourceRect sourceRect; // 아틀라스 영역 (기본값 = 텍스처 전체)
+
+    InputQueue input;
+    bool mouseInside = false; // WM_MOUSELEAVE 추적 (프레젠터 스레드 전용)
+    std::atomic<long long> lastPresentNs{ 0 }; // Present 직후 시각 (입력 -> 표시 지연 측정용)
+
+    // 크기 조정 (프레젠터 스레드 전용). 드래그 중에는 ResizeBuffers를 미루고 이전 백버퍼를 늘려서 보여줌
+    bool inSizeMove = false;
+    bool resizePending = false; int pendingW = 0, pendingH = 0; ULONGLONG lastSizeChangeTick = 0;
+    int bufferW = 0, bufferH = 0;
+    std::function<void()> presentDuringSizeMove; // WM_TIMER에서 호출
 
     EventCallbackFunc eventCallback = nullptr;
     CloseCallbackFunc closeCallback = nullptr;
 };
 
+static HandleTable<D3D11WindowContext> g_Windows;
+
 void SetupTransparency(HWND hWnd, bool enable) {
     MARGINS margins = { enable ? -1 : 0 };
     DwmExtendFrameIntoClientArea(hWnd, &margins);
 }
 
+// 콜백 호출 (트레이스 포함)
+static void DispatchEvent(D3D11WindowContext* ctx, int type, int data1, int data2) {
+    if (!ctx->eventCallback) return;
+    TraceScope trace("EventCallback", ctx->handle);
+    ctx->eventCallback(ctx->handle, type, data1, data2);
+}
+
+static bool DispatchClose(D3D11WindowContext* ctx) {
+    if (!ctx->closeCallback) return true;
+    TraceScope trace("CloseCallback", ctx->handle);
+    return ctx->closeCallback(ctx->handle);
+}
+
+// 윈도우 입력 메시지 -> InputEvent. 입력 메시지가 아니면 false
+static bool TranslateInput(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam, InputEvent& e) {
+    e = InputEvent();
+    e.receiveTimeNs = MonotonicNowNs();
+    e.serverTime = (unsigned int)GetMessageTime();
+    e.x = (short)LOWORD(lParam); e.y = (short)HIWORD(lParam);
+    switch (message) {
+    case WM_KEYDOWN: case WM_SYSKEYDOWN: e.type = INPUT_KEY_DOWN; e.code = (int)wParam; e.x = e.y = 0; break;
+    case WM_KEYUP: case WM_SYSKEYUP: e.type = INPUT_KEY_UP; e.code = (int)wParam; e.x = e.y = 0; break;
+    case WM_LBUTTONDOWN: e.type = INPUT_BUTTON_DOWN; e.code = 0; break;
+    case WM_LBUTTONUP: e.type = INPUT_BUTTON_UP; e.code = 0; break;
+    case WM_RBUTTONDOWN: e.type = INPUT_BUTTON_DOWN; e.code = 1; break;
+    case WM_RBUTTONUP: e.type = INPUT_BUTTON_UP; e.code = 1; break;
+    case WM_MBUTTONDOWN: e.type = INPUT_BUTTON_DOWN; e.code = 2; break;
+    case WM_MBUTTONUP: e.type = INPUT_BUTTON_UP; e.code = 2; break;
+    case WM_XBUTTONDOWN: e.type = INPUT_BUTTON_DOWN; e.code = HIWORD(wParam) == XBUTTON1 ? 3 : 4; break;
+    case WM_XBUTTONUP: e.type = INPUT_BUTTON_UP; e.code = HIWORD(wParam) == XBUTTON1 ? 3 : 4; break;
+    case WM_MOUSEMOVE: e.type = INPUT_MOTION; break;
+    case WM_MOUSEWHEEL: case WM_MOUSEHWHEEL: {
+        e.type = message == WM_MOUSEWHEEL ? INPUT_WHEEL : INPUT_WHEEL_H;
+        e.code = (short)HIWORD(wParam);
+        POINT p = { e.x, e.y }; ScreenToClient(hWnd, &p); // 휠 좌표는 화면 기준
+        e.x = p.x; e.y = p.y;
+        break;
+    }
+    case WM_MOUSELEAVE: e.type = INPUT_LEAVE; e.x = e.y = 0; break;
+    default:
+        return false;
+    }
+    e.modifiers = (GetKeyState(VK_SHIFT) < 0 ? INPUT_MOD_SHIFT : 0) | (GetKeyState(VK_CONTROL) < 0 ? INPUT_MOD_CTRL : 0) | (GetKeyState(VK_MENU) < 0 ? INPUT_MOD_ALT : 0);
+    return true;
+}
+
 LRESULT CALLBACK GlobalWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
     D3D11WindowContext* ctx = nullptr;
     if (message == WM_NCCREATE) {
@@ -52,33 +302,139 @@ LRESULT CALLBACK GlobalWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lP
 
     if (!ctx) return DefWindowProc(hWnd, message, wParam, lParam);
 
+    InputEvent input;
+    if (TranslateInput(hWnd, message, wParam, lParam, input)) {
+        if (input.type == INPUT_MOTION && !ctx->mouseInside) {
+            TRACKMOUSEEVENT tme = { sizeof(TRACKMOUSEEVENT), TME_LEAVE, hWnd, 0 };
+            TrackMouseEvent(&tme);
+            ctx->mouseInside = true;
+            InputEvent enter = input; enter.type = INPUT_ENTER;
+            ctx->input.Push(enter);
+        }
+        else if (input.type == INPUT_LEAVE) ctx->mouseInside = false;
+        ctx->input.Push(input);
+    }
+
     switch (message) {
     case WM_CLOSE:
-        if (ctx->closeCallback && !ctx->closeCallback(ctx)) return 0;
+        if (!DispatchClose(ctx)) return 0;
         ctx->isRunning = false;
-        if (ctx->eventCallback) ctx->eventCallback(ctx, EVENT_CLOSED, 0, 0);
+        DispatchEvent(ctx, EVENT_CLOSED, 0, 0);
         return 0;
     case WM_SIZE: {
         int w = LOWORD(lParam), h = HIWORD(lParam);
         if (wParam == SIZE_MAXIMIZED || wParam == SIZE_RESTORED) {
-            if (ctx->eventCallback) ctx->eventCallback(ctx, EVENT_RESIZED, w, h);
+            // 여기서는 기록만 하고 ResizeBuffers는 프레젠터가 프레임당 최대 한 번 결정
+            ctx->resizePending = w != ctx->bufferW || h != ctx->bufferH;
+            ctx->pendingW = w; ctx->pendingH = h; ctx->lastSizeChangeTick = GetTickCount64();
+            DispatchEvent(ctx, EVENT_RESIZED, w, h);
         }
         break;
     }
+    case WM_ENTERSIZEMOVE:
+        // 드래그 동안은 DefWindowProc의 모달 루프가 프레젠터 루프를 막으므로 타이머로 계속 Present
+        ctx->inSizeMove = true;
+        SetTimer(hWnd, SIZE_MOVE_TIMER_ID, 15, NULL);
+        break;
+    case WM_EXITSIZEMOVE:
+        ctx->inSizeMove = false;
+        ctx->lastSizeChangeTick = 0; // 드래그가 끝났으니 바로 ResizeBuffers
+        KillTimer(hWnd, SIZE_MOVE_TIMER_ID);
+        break;
+    case WM_TIMER:
+        if (wParam != SIZE_MOVE_TIMER_ID) return 0;
+        if (!ctx->isRunning || !g_UnityDevice) {
+            // 창 닫기/디바이스 종료: 드래그 모달 루프를 끝내야 프레젠터 루프가 빠져나감 (마우스 캡처 해제)
+            KillTimer(hWnd, SIZE_MOVE_TIMER_ID);
+            SendMessage(hWnd, WM_CANCELMODE, 0, 0);
+            return 0;
+        }
+        if (ctx->presentDuringSizeMove) ctx->presentDuringSizeMove();
+        return 0;
     case WM_MOVE:
-        if (ctx->eventCallback) ctx->eventCallback(ctx, EVENT_MOVED, (short)LOWORD(lParam), (short)HIWORD(lParam));
+        DispatchEvent(ctx, EVENT_MOVED, (short)LOWORD(lParam), (short)HIWORD(lParam));
         break;
     case WM_SETFOCUS:
-        if (ctx->eventCallback) ctx->eventCallback(ctx, EVENT_FOCUS_GAINED, 0, 0);
+        DispatchEvent(ctx, EVENT_FOCUS_GAINED, 0, 0);
         break;
     }
     return DefWindowProc(hWnd, message, wParam, lParam);
 }
 
+// 프레임 내보내기용 비동기 읽기. 스테이징 텍스처 두 개를 번갈아 쓰고 한 프레임 늦게 맵함
+// 이전 프레임 복사가 아직 안 끝났으면 (DO_NOT_WAIT) 기다리지 않고 그 프레임을 버림
+// 호출자가 ID3D10Multithread와 backBufferMutex를 잡은 상태에서 Present 전에 호출
+struct D3D11FrameReadback {
+    ID3D11Texture2D* staging[2] = { nullptr, nullptr };
+    bool pending[2] = { false, false };
+    int index = 0;
+
+    void Capture(ID3D11Device* device, ID3D11DeviceContext* context, FrameExporter* exporter, ID3D11Texture2D* backBuffer) {
+        int prev = index ^ 1;
+        if (pending[prev]) {
+            pending[prev] = false;
+            D3D11_TEXTURE2D_DESC desc; staging[prev]->GetDesc(&desc);
+            D3D11_MAPPED_SUBRESOURCE mapped;
+            if (SUCCEEDED(context->Map(staging[prev], 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped))) {
+                uint8_t* dst = exporter->BeginWrite(desc.Width, desc.Height);
+                if (dst) {
+                    for (UINT y = 0; y < desc.Height; y++)
+                        memcpy(dst + (size_t)y * desc.Width * 4, (uint8_t*)mapped.pData + (size_t)y * mapped.RowPitch, (size_t)desc.Width * 4);
+                    exporter->EndWrite(0);
+                }
+                context->Unmap(staging[prev], 0);
+            }
+        }
+
+        D3D11_TEXTURE2D_DESC bb; backBuffer->GetDesc(&bb);
+        if (bb.Width <= exporter->MaxWidth() && bb.Height <= exporter->MaxHeight()) {
+            if (staging[index]) {
+                D3D11_TEXTURE2D_DESC sd; staging[index]->GetDesc(&sd);
+                if (sd.Width != bb.Width || sd.Height != bb.Height) { staging[index]->Release(); staging[index] = nullptr; }
+            }
+            if (!staging[index]) {
+                D3D11_TEXTURE2D_DESC sd = bb;
+                sd.Usage = D3D11_USAGE_STAGING; sd.BindFlags = 0; sd.CPUAccessFlags = D3D11_CPU_ACCESS_READ; sd.MiscFlags = 0;
+                device->CreateTexture2D(&sd, NULL, &staging[index]);
+            }
+            if (staging[index]) { context->CopyResource(staging[index], backBuffer); pending[index] = true; }
+        }
+        index = prev;
+    }
+
+    void Release() {
+        for (int i = 0; i < 2; i++) {
+            if (staging[i]) { staging[i]->Release(); staging[i] = nullptr; }
+            pending[i] = false;
+        }
+        index = 0;
+    }
+};
+
+// 호출한 스레드 자신에게 적용 (프레젠터 스레드가 명령을 받아서 호출)
+static void ApplyThreadPolicy(unsigned long long cpuMask, int priority) {
+    DWORD_PTR processMask = 0, systemMask = 0;
+    GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+    DWORD_PTR mask = cpuMask ? ((DWORD_PTR)cpuMask & processMask) : processMask;
+    if (mask) SetThreadAffinityMask(GetCurrentThread(), mask);
+
+    int winPriority = THREAD_PRIORITY_NORMAL;
+    if (priority == PRIORITY_ABOVE_NORMAL) winPriority = THREAD_PRIORITY_ABOVE_NORMAL;
+    else if (priority == PRIORITY_HIGH) winPriority = THREAD_PRIORITY_HIGHEST;
+    else if (priority >= PRIORITY_REALTIME) winPriority = THREAD_PRIORITY_TIME_CRITICAL;
+    SetThreadPriority(GetCurrentThread(), winPriority);
+}
+
 void RenderThreadLoop(D3D11WindowContext* ctx, int width, int height) {
+    SetThreadDescription(GetCurrentThread(), (L"mw-present-" + std::to_wstring(ctx->id)).c_str());
+
     // 1. 유니티 준비 대기
     for (int i = 0; i < 50; i++) { if (g_UnityDevice) break; Sleep(50); }
-    if (!g_UnityDevice) { ctx->isRunning = false; return; }
+    g_ActivePresenters++; // 먼저 올려야 디바이스 종료가 아래에서 잡는 multithread를 놓지 않고 기다림
+    ID3D11Device* device = g_UnityDevice;
+    if (!device) { ctx->isRunning = false; g_ActivePresenters--; return; }
+    ID3D10Multithread* multithread = g_Multithread; // 이 스레드 전용 참조 (전역 포인터는 종료 때 바뀜)
+    if (multithread) multithread->AddRef();
 
     // [핵심 수정 1] 윈도우 클래스 이름을 인스턴스마다 다르게 설정 (충돌 방지)
     std::string className = "DX11SubWin_" + std::to_string((unsigned long long)ctx);
@@ -103,150 +459,390 @@ void RenderThreadLoop(D3D11WindowContext* ctx, int width, int height) {
     sd.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
 
     IDXGISwapChain* swapChain = nullptr;
-    if (g_Multithread) g_Multithread->Enter();
-    HRESULT hr = factory->CreateSwapChain(g_UnityDevice, &sd, &swapChain);
-    if (g_Multithread) g_Multithread->Leave();
-
-    if (FAILED(hr) || !swapChain) { if (factory) factory->Release(); DestroyWindow(hWnd); return; }
+    if (multithread) multithread->Enter();
+    HRESULT hr = factory->CreateSwapChain(device, &sd, &swapChain);
+    if (multithread) multithread->Leave();
+
+    if (FAILED(hr) || !swapChain) {
+        if (factory) factory->Release();
+        if (multithread) multithread->Release();
+        g_ActivePresenters--;
+        DestroyWindow(hWnd);
+        return;
+    }
 
-    ID3D11Texture2D* backBuffer = nullptr;
-    swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)&backBuffer);
+    {
+        std::lock_guard<std::mutex> lock(ctx->backBufferMutex);
+        swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)&ctx->backBuffer);
+    }
 
     ID3D11DeviceContext* context = nullptr;
-    g_UnityDevice->GetImmediateContext(&context);
+    device->GetImmediateContext(&context);
+
+    FrameExporter* exporter = nullptr; D3D11FrameReadback readback;
+    ctx->bufferW = width; ctx->bufferH = height; ctx->resizePending = false; // 생성 중 WM_SIZE는 무시
+
+    unsigned long long presentedSeq = 0; // 마지막 Present 때의 copySeq
+    // 한 프레임 표시: (필요하면) 백버퍼 크기 조정 -> 복사 -> 내보내기 -> Present
+    // 드래그 중에는 모달 루프 안의 WM_TIMER에서도 불림
+    auto presentFrame = [&]() {
+        if (!g_UnityDevice) return; // 디바이스 종료 중 (드래그 모달 루프 안에서도 불리므로 여기서도 확인)
+        ID3D11Texture2D* source = ctx->sharedTexture;
+        bool forceCopy = false;
+
+        // 크기 조정은 프레임당 최대 한 번. 그 전까지는 이전 백버퍼를 DXGI가 창 크기에 맞춰 늘려서 보여줌
+        // - 원본 영역이 새 크기와 같으면: 드래그 중이 아니거나, 드래그 중 RESIZE_SETTLE_MS 동안 멈췄을 때
+        // - 쿼드로 늘려 그리는 원본이면: 크기가 RESIZE_SETTLE_MS 동안 안 바뀌었거나 드래그가 끝났을 때도
+        //   (복사 대체 경로는 늘리지 못하므로 크기가 다르면 바꾸지 않음. 바꾸면 잘린 그림이 됨)
+        if (ctx->resizePending) {
+            bool settled = GetTickCount64() - ctx->lastSizeChangeTick >= RESIZE_SETTLE_MS;
+            bool sourceMatches = false;
+            if (source) {
+                D3D11_BOX box = SourceBox(source, ctx->sourceRect);
+                sourceMatches = (int)(box.right - box.left) == ctx->pendingW && (int)(box.bottom - box.top) == ctx->pendingH;
+            }
+            std::lock_guard<std::mutex> lock(ctx->backBufferMutex);
+            bool canScale = ctx->blitter.lastDrawScaled;
+            if ((sourceMatches && (!ctx->inSizeMove || settled)) || (settled && canScale)) {
+                TraceScope trace("ResizeBuffers", ctx->handle);
+                if (multithread) multithread->Enter();
+                ctx->blitter.ReleaseTarget();
+                if (ctx->backBuffer) { ctx->backBuffer->Release(); ctx->backBuffer = nullptr; }
+                if (SUCCEEDED(swapChain->ResizeBuffers(0, ctx->pendingW, ctx->pendingH, DXGI_FORMAT_UNKNOWN, 0))) {
+                    ctx->bufferW = ctx->pendingW; ctx->bufferH = ctx->pendingH;
+                }
+                swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)&ctx->backBuffer);
+                if (multithread) multithread->Leave();
+                ctx->resizePending = false;
+                forceCopy = true; // 새 백버퍼는 비어 있으므로 렌더 이벤트 모드여도 마지막 원본을 한 번 그림
+            }
+        }
+
+        // 렌더 이벤트 모드에서는 이미 유니티 렌더 스레드가 그려 둠
+        // copySeq가 마지막으로 Present한 값보다 앞서지 않으면 Present하지 않음 (DISCARD 백버퍼는 Present 뒤 내용이 정의되지 않음)
+        // 확인부터 Present까지 backBufferMutex를 잡고 있어서 그 사이에 렌더 스레드가 다음 프레임을 그리지 못함
+        std::lock_guard<std::mutex> lock(ctx->backBufferMutex);
+        if (ctx->renderEventMode) {
+            if (!ctx->renderEventAllowed || MonotonicNowNs() - ctx->lastRenderEventNs > RENDER_EVENT_TIMEOUT_NS) ctx->renderEventMode = false;
+            else if (ctx->copySeq == presentedSeq && !forceCopy) return;
+        }
+        if ((forceCopy || !ctx->renderEventMode) && source && ctx->backBuffer && context) {
+            TraceScope trace("Draw", ctx->handle);
+            if (multithread) multithread->Enter();
+            ctx->blitter.Draw(device, context, ctx->backBuffer, source, ctx->sourceRect);
+            if (multithread) multithread->Leave();
+        }
+
+        if (exporter && context && ctx->backBuffer) {
+            TraceScope trace("ExportReadback", ctx->handle);
+            if (multithread) multithread->Enter();
+            readback.Capture(device, context, exporter, ctx->backBuffer);
+            if (multithread) multithread->Leave();
+        }
+
+        HRESULT res;
+        { TraceScope trace("Present", ctx->handle); res = swapChain->Present(1, 0); }
+        presentedSeq = ctx->copySeq;
+        ctx->lastPresentNs = MonotonicNowNs();
+        if (res == DXGI_ERROR_DEVICE_REMOVED || res == DXGI_ERROR_DEVICE_RESET) ctx->isRunning = false;
+    };
+
+    // 텍스처/영역 명령 (드래그 중 모달 루프에서도 적용해야 유니티가 새 크기로 만든 텍스처를 바로 씀)
+    auto applyFrameCommand = [&](const WindowCommand& cmd) {
+        if (cmd.textureDirty) { TraceScope t("TextureSwap", ctx->handle); ctx->sharedTexture = (ID3D11Texture2D*)cmd.newTexturePtr; }
+        if (cmd.sourceDirty) { std::lock_guard<std::mutex> lock(ctx->backBufferMutex); ctx->sourceRect = cmd.source; }
+    };
+    ctx->presentDuringSizeMove = [&]() {
+        WindowCommand cmd;
+        if (TakeFrameCommand(ctx->mutex, ctx->cmd, cmd)) applyFrameCommand(cmd);
+        presentFrame();
+    };
 
     ShowWindow(hWnd, SW_SHOWDEFAULT);
     ctx->hRenderEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
     ctx->isRunning = true;
 
+    long long lastFrameNs = 0; // 마지막으로 명령 처리/Present까지 간 시각
     while (ctx->isRunning) {
-        WaitForSingleObject(ctx->hRenderEvent, 200);
-        MSG msg;
-        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) { TranslateMessage(&msg); DispatchMessage(&msg); }
-        if (!ctx->isRunning) break;
-
+        // 입력 메시지가 오면 프레임 신호를 기다리지 않고 바로 깨어나서 큐에 넣음
+        // 입력만으로 깨어났으면 Present는 건너뛰지만, 마우스가 계속 움직여도 FRAME_INTERVAL_NS마다는 아래로 내려감
+        DWORD wake = MsgWaitForMultipleObjects(1, &ctx->hRenderEvent, FALSE, 200, QS_ALLINPUT);
         {
-            std::lock_guard<std::mutex> lock(ctx->mutex);
-            if (ctx->cmd.textureDirty) {
-                ctx->sharedTexture = (ID3D11Texture2D*)ctx->cmd.newTexturePtr;
-                ctx->cmd.textureDirty = false;
-            }
-            if (ctx->cmd.focusCmdDirty && ctx->cmd.setFocus) {
-                SetForegroundWindow(hWnd); SetFocus(hWnd); ctx->cmd.focusCmdDirty = false;
-            }
-            if (ctx->cmd.rectDirty) {
-                RECT r = { 0, 0, ctx->cmd.w, ctx->cmd.h };
+            TraceScope trace("DrainEvents", ctx->handle);
+            MSG msg;
+            while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) { TranslateMessage(&msg); DispatchMessage(&msg); }
+        }
+        if (!ctx->isRunning || !g_UnityDevice) break; // 디바이스 종료
+        long long now = MonotonicNowNs();
+        if (wake == WAIT_OBJECT_0 + 1 && now - lastFrameNs < FRAME_INTERVAL_NS) continue;
+        lastFrameNs = now;
+
+        WindowCommand cmd;
+        if (TakeWindowCommand(ctx->mutex, ctx->cmd, cmd)) {
+            TraceScope trace("ApplyCommand", ctx->handle);
+            applyFrameCommand(cmd);
+            if (cmd.policyDirty) ApplyThreadPolicy(cmd.cpuMask, cmd.priority);
+            if (cmd.exportDirty) { readback.Release(); delete exporter; exporter = (FrameExporter*)cmd.exporter; }
+            if (cmd.focusCmdDirty && cmd.setFocus) { SetForegroundWindow(hWnd); SetFocus(hWnd); }
+            if (cmd.rectDirty) {
+                TraceScope t("ApplyRect", ctx->handle);
+                RECT r = { 0, 0, cmd.w, cmd.h };
                 AdjustWindowRect(&r, GetWindowLong(hWnd, GWL_STYLE), FALSE);
-                SetWindowPos(hWnd, NULL, ctx->cmd.x, ctx->cmd.y, r.right - r.left, r.bottom - r.top, SWP_NOZORDER);
-                ctx->cmd.rectDirty = false;
+                SetWindowPos(hWnd, NULL, cmd.x, cmd.y, r.right - r.left, r.bottom - r.top, SWP_NOZORDER);
             }
-            if (ctx->cmd.styleDirty) {
+            if (cmd.styleDirty) {
+                TraceScope t("ApplyStyle", ctx->handle);
                 LONG_PTR style = GetWindowLongPtr(hWnd, GWL_STYLE);
-                if (ctx->cmd.borderless) { style &= ~WS_OVERLAPPEDWINDOW; style |= WS_POPUP; }
+                if (cmd.borderless) { style &= ~WS_OVERLAPPEDWINDOW; style |= WS_POPUP; }
                 else {
                     style |= WS_OVERLAPPEDWINDOW; style &= ~WS_POPUP;
-                    if (ctx->cmd.hasMinBtn) style |= WS_MINIMIZEBOX; else style &= ~WS_MINIMIZEBOX;
-                    if (ctx->cmd.hasMaxBtn) style |= WS_MAXIMIZEBOX; else style &= ~WS_MAXIMIZEBOX;
-                    if (ctx->cmd.resizable) style |= WS_THICKFRAME; else style &= ~WS_THICKFRAME;
+                    if (cmd.hasMinBtn) style |= WS_MINIMIZEBOX; else style &= ~WS_MINIMIZEBOX;
+                    if (cmd.hasMaxBtn) style |= WS_MAXIMIZEBOX; else style &= ~WS_MAXIMIZEBOX;
+                    if (cmd.resizable) style |= WS_THICKFRAME; else style &= ~WS_THICKFRAME;
                 }
                 SetWindowLongPtr(hWnd, GWL_STYLE, style);
-                SetupTransparency(hWnd, ctx->cmd.transparent);
+                SetupTransparency(hWnd, cmd.transparent);
                 SetWindowPos(hWnd, NULL, 0, 0, 0, 0, SWP_FRAMECHANGED | SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER);
-                ctx->cmd.styleDirty = false;
             }
-            if (ctx->cmd.titleDirty) { SetWindowText(hWnd, ctx->cmd.title); ctx->cmd.titleDirty = false; }
-        }
-
-        if (ctx->sharedTexture && backBuffer && context) {
-            if (g_Multithread) g_Multithread->Enter();
-            context->CopyResource(backBuffer, ctx->sharedTexture);
-            if (g_Multithread) g_Multithread->Leave();
+            if (cmd.titleDirty) { TraceScope t("ApplyTitle", ctx->handle); SetWindowText(hWnd, cmd.title); }
         }
 
-        HRESULT res = swapChain->Present(1, 0);
-        if (res == DXGI_ERROR_DEVICE_REMOVED || res == DXGI_ERROR_DEVICE_RESET) ctx->isRunning = false;
+        presentFrame();
     }
 
-    if (ctx->hRenderEvent) CloseHandle(ctx->hRenderEvent);
-    if (backBuffer) backBuffer->Release();
+    ctx->presentDuringSizeMove = nullptr;
+    readback.Release(); delete exporter;
+    {
+        std::lock_guard<std::mutex> lock(ctx->backBufferMutex);
+        ctx->blitter.Release();
+        if (ctx->backBuffer) { ctx->backBuffer->Release(); ctx->backBuffer = nullptr; }
+    }
     if (swapChain) swapChain->Release();
     if (factory) factory->Release();
     if (context) context->Release();
+    if (multithread) multithread->Release();
+    g_ActivePresenters--;
     DestroyWindow(hWnd);
     UnregisterClass(className.c_str(), wc.hInstance); // 클래스 해제
 }
 
+// 유니티 렌더 스레드에서 실행 (CommandBuffer.IssuePluginEventAndData(GetRenderEventFunc(), GetRenderEventID(), handle))
+// 유니티 자신의 컨텍스트에서 그리므로 ID3D10Multithread Enter/Leave가 필요 없음
+static void UNITY_INTERFACE_API OnRenderEvent(int eventId, void* data) {
+    if (eventId != g_RenderEventID) return;
+    std::lock_guard<std::mutex> eventLock(g_RenderEventMutex);
+    D3D11WindowContext* ctx = g_Windows.Get(data);
+    if (!ctx || !ctx->isRunning) return;
+    if (!ctx->renderEventAllowed) { if (ctx->hRenderEvent) SetEvent(ctx->hRenderEvent); return; } // SignalFrameReady처럼만 동작
+    TraceScope trace("RenderEventCopy", ctx->handle);
+    ctx->lastRenderEventNs = MonotonicNowNs();
+    ctx->renderEventMode = true;
+
+    ID3D11Device* device = g_UnityDevice;
+    ID3D11Texture2D* source = ctx->sharedTexture;
+    if (device && source) {
+        std::lock_guard<std::mutex> lock(ctx->backBufferMutex);
+        if (ctx->backBuffer) {
+            ID3D11DeviceContext* context = nullptr;
+            device->GetImmediateContext(&context);
+            ctx->blitter.Draw(device, context, ctx->backBuffer, source, ctx->sourceRect);
+            context->Release();
+            ctx->copySeq++;
+        }
+    }
+    if (ctx->hRenderEvent) SetEvent(ctx->hRenderEvent);
+}
+
+static void UNITY_INTERFACE_API OnGraphicsDeviceEvent(UnityGfxDeviceEventType eventType) {
+    if (eventType == kUnityGfxDeviceEventInitialize) {
+        auto* gfx = g_UnityInterfaces->Get<IUnityGraphicsD3D11>();
+        ID3D11Device* device = gfx ? gfx->GetDevice() : nullptr;
+        if (device && !g_Multithread) {
+            // ID3D10Multithread로 멀티스레드 보호 활성화
+            ID3D10Multithread* multithread = nullptr;
+            device->QueryInterface(__uuidof(ID3D10Multithread), (void**)&multithread);
+            if (multithread) multithread->SetMultithreadProtected(TRUE);
+            g_Multithread = multithread;
+        }
+        g_UnityDevice = device;
+    }
+    else if (eventType == kUnityGfxDeviceEventShutdown) {
+        // 프레젠터들이 스왑체인을 놓고 끝날 때까지 대기 (프레젠터는 최대 200ms마다 깨어나고, 드래그 중이면 타이머가 모달 루프를 끝냄)
+        // 프레젠터마다 자기 ID3D10Multithread 참조를 잡고 있으므로 여기서 전역 참조를 놓아도 Enter/Leave는 안전함
+        g_UnityDevice = nullptr;
+        for (int i = 0; i < 200 && g_ActivePresenters > 0; i++) Sleep(10);
+        ID3D10Multithread* multithread = g_Multithread.exchange(nullptr);
+        if (multithread) multithread->Release();
+    }
+}
+
 extern "C" {
     UNITY_INTERFACE_EXPORT void UnityPluginLoad(IUnityInterfaces* i) {
-        auto* gfx = i->Get<IUnityGraphicsD3D11>();
-        if (gfx) {
-            g_UnityDevice = gfx->GetDevice();
-            if (g_UnityDevice) {
-                // ID3D10Multithread로 멀티스레드 보호 활성화
-                g_UnityDevice->QueryInterface(__uuidof(ID3D10Multithread), (void**)&g_Multithread);
-                if (g_Multithread) g_Multithread->SetMultithreadProtected(TRUE);
-            }
+        g_UnityInterfaces = i;
+        g_Graphics = i->Get<IUnityGraphics>();
+        if (g_Graphics) {
+            g_RenderEventID = g_Graphics->ReserveEventIDRange(1);
+            g_Graphics->RegisterDeviceEventCallback(OnGraphicsDeviceEvent);
         }
+        // 디바이스가 이미 만들어진 뒤에 로드되면 Initialize 이벤트를 놓치므로 직접 호출
+        OnGraphicsDeviceEvent(kUnityGfxDeviceEventInitialize);
     }
 
     UNITY_INTERFACE_EXPORT void UnityPluginUnload() {
-        if (g_Multithread) { g_Multithread->Release(); g_Multithread = nullptr; }
+        if (g_Graphics) g_Graphics->UnregisterDeviceEventCallback(OnGraphicsDeviceEvent);
+        OnGraphicsDeviceEvent(kUnityGfxDeviceEventShutdown);
     }
 
+    UNITY_INTERFACE_EXPORT UnityRenderingEventAndData GetRenderEventFunc() { return OnRenderEvent; }
+    UNITY_INTERFACE_EXPORT int GetRenderEventID() { return g_RenderEventID; }
+
     UNITY_INTERFACE_EXPORT void* StartSubWindow(void* texturePtr, int w, int h) {
         if (!g_UnityDevice) return nullptr; // 디바이스 없으면 시작 안 함 (안전장치)
 
         D3D11WindowContext* ctx = new D3D11WindowContext();
+        ctx->handle = g_Windows.Add(ctx);
+        if (!ctx->handle) { delete ctx; return nullptr; } // 테이블 가득 참
+        ctx->id = g_NextWindowId++;
         ctx->sharedTexture = (ID3D11Texture2D*)texturePtr;
         ctx->isRunning = true;
         ctx->renderThread = std::thread(RenderThreadLoop, ctx, w, h);
-        return (void*)ctx;
+        return ctx->handle;
     }
 
-    // ... (나머지 StopSubWindow 등 함수들은 그대로 유지) ...
     UNITY_INTERFACE_EXPORT void StopSubWindow(void* handle) {
-        D3D11WindowContext* ctx = (D3D11WindowContext*)handle;
+        D3D11WindowContext* ctx = g_Windows.Remove(handle); // 이후 같은 핸들로 오는 호출은 모두 무시됨
         if (!ctx) return;
         ctx->isRunning = false;
         if (ctx->hRenderEvent) SetEvent(ctx->hRenderEvent);
         if (ctx->renderThread.joinable()) ctx->renderThread.join();
+        if (ctx->cmd.exportDirty) delete (FrameExporter*)ctx->cmd.exporter; // 프레젠터가 못 가져간 것
+        { std::lock_guard<std::mutex> eventLock(g_RenderEventMutex); } // 렌더 스레드에서 이 창을 쓰는 중이면 끝날 때까지
+        if (ctx->hRenderEvent) CloseHandle(ctx->hRenderEvent); // 이제 SetEvent 할 수 있는 곳이 없음
         delete ctx;
     }
 
     UNITY_INTERFACE_EXPORT void SignalFrameReady(void* handle) {
-        D3D11WindowContext* ctx = (D3D11WindowContext*)handle;
+        TraceScope trace("SignalFrameReady", handle);
+        D3D11WindowContext* ctx = g_Windows.Get(handle);
         if (ctx && ctx->hRenderEvent) SetEvent(ctx->hRenderEvent);
     }
 
-    // ... (SetEventCallback, SetCloseCallback, UpdateTexture, FocusWindow, SetConfig 등은 기존과 동일) ...
-    // 복사해서 넣으시면 됩니다.
+    // false면 이 창의 렌더 이벤트는 SignalFrameReady처럼 깨우기만 하고 복사는 프레젠터가 함 (기본값 true)
+    UNITY_INTERFACE_EXPORT void SetRenderEventMode(void* handle, bool enabled) {
+        D3D11WindowContext* ctx = g_Windows.Get(handle);
+        if (!ctx) return;
+        ctx->renderEventAllowed = enabled;
+        if (ctx->hRenderEvent) SetEvent(ctx->hRenderEvent);
+    }
+
     UNITY_INTERFACE_EXPORT void SetEventCallback(void* handle, EventCallbackFunc callback) {
-        D3D11WindowContext* ctx = (D3D11WindowContext*)handle;
+        D3D11WindowContext* ctx = g_Windows.Get(handle);
         if (ctx) ctx->eventCallback = callback;
     }
     UNITY_INTERFACE_EXPORT void SetCloseCallback(void* handle, CloseCallbackFunc callback) {
-        D3D11WindowContext* ctx = (D3D11WindowContext*)handle;
+        D3D11WindowContext* ctx = g_Windows.Get(handle);
         if (ctx) ctx->closeCallback = callback;
     }
     UNITY_INTERFACE_EXPORT void UpdateTexture(void* handle, void* newPtr) {
-        D3D11WindowContext* ctx = (D3D11WindowContext*)handle;
+        D3D11WindowContext* ctx = g_Windows.Get(handle);
         if (!ctx) return;
         std::lock_guard<std::mutex> lock(ctx->mutex);
         ctx->cmd.newTexturePtr = newPtr; ctx->cmd.textureDirty = true;
     }
     UNITY_INTERFACE_EXPORT void FocusWindow(void* handle) {
-        D3D11WindowContext* ctx = (D3D11WindowContext*)handle;
+        D3D11WindowContext* ctx = g_Windows.Get(handle);
         if (ctx) { std::lock_guard<std::mutex> lock(ctx->mutex); ctx->cmd.setFocus = true; ctx->cmd.focusCmdDirty = true; }
     }
     UNITY_INTERFACE_EXPORT void SetConfig(void* handle, int x, int y, int w, int h, const char* title,
         bool borderless, bool transparent, bool resizable, bool minBtn, bool maxBtn) {
-        D3D11WindowContext* ctx = (D3D11WindowContext*)handle;
+        D3D11WindowContext* ctx = g_Windows.Get(handle);
+        if (!ctx) return;
+        WindowConfig config = { x, y, w, h, title, borderless, transparent, resizable, minBtn, maxBtn };
+        std::lock_guard<std::mutex> lock(ctx->mutex);
+        ApplyWindowConfig(ctx->cmd, config);
+    }
+
+    // 일괄 호출: 창 여러 개를 P/Invoke 한 번으로 처리. 잘못된(닫힌) 핸들은 건너뜀
+    UNITY_INTERFACE_EXPORT void SetConfigBatch(void** handles, const WindowConfig* configs, int count) {
+        for (int i = 0; i < count; i++) {
+            D3D11WindowContext* ctx = g_Windows.Get(handles[i]);
+            if (!ctx) continue;
+            std::lock_guard<std::mutex> lock(ctx->mutex);
+            ApplyWindowConfig(ctx->cmd, configs[i]);
+        }
+    }
+    // 아틀라스 모드: 원본 텍스처에서 보여줄 영역 (UV 0~1). 같은 텍스처를 여러 창에 넘기고 영역만 다르게 주면 됨
+    // 영역은 창 크기에 맞춰 늘어남 (원본이 MSAA거나 셰이더 리소스가 아니면 늘리지 않고 왼쪽 위로 복사)
+    UNITY_INTERFACE_EXPORT void SetSourceRect(void* handle, float u0, float v0, float u1, float v1, bool flipY) {
+        D3D11WindowContext* ctx = g_Windows.Get(handle);
+        if (!ctx) return;
+        std::lock_guard<std::mutex> lock(ctx->mutex);
+        ctx->cmd.source.u0 = u0; ctx->cmd.source.v0 = v0; ctx->cmd.source.u1 = u1; ctx->cmd.source.v1 = v1;
+        ctx->cmd.source.flipY = flipY; ctx->cmd.sourceDirty = true;
+    }
+    UNITY_INTERFACE_EXPORT void SetSourceRectBatch(void** handles, const SourceRect* rects, int count) {
+        for (int i = 0; i < count; i++) {
+            D3D11WindowContext* ctx = g_Windows.Get(handles[i]);
+            if (!ctx) continue;
+            std::lock_guard<std::mutex> lock(ctx->mutex);
+            ctx->cmd.source = rects[i]; ctx->cmd.sourceDirty = true;
+        }
+    }
+    // 입력: 유니티가 프레임당 한 번 비움. 반환값 = out에 채운 개수
+    UNITY_INTERFACE_EXPORT int PollInputEvents(void* handle, InputEvent* out, int maxCount) {
+        D3D11WindowContext* ctx = g_Windows.Get(handle);
+        return ctx ? ctx->input.Drain(out, maxCount) : 0;
+    }
+    // 기본값 true: PollInputEvents 한 번에 연속된 모션은 마지막 것만 돌려줌. false면 모든 모션 이벤트를 그대로 보냄
+    UNITY_INTERFACE_EXPORT void SetInputMotionCoalescing(void* handle, bool enabled) {
+        D3D11WindowContext* ctx = g_Windows.Get(handle);
+        if (ctx) ctx->input.coalesceMotion = enabled;
+    }
+    // InputEvent.receiveTimeNs와 같은 시계
+    UNITY_INTERFACE_EXPORT long long GetNativeTime() { return MonotonicNowNs(); }
+    UNITY_INTERFACE_EXPORT long long GetLastPresentTime(void* handle) {
+        D3D11WindowContext* ctx = g_Windows.Get(handle);
+        return ctx ? ctx->lastPresentNs.load() : 0;
+    }
+    // 프레임 내보내기: 표시되는 프레임을 이름 있는 공유 메모리 링(name, 예: "Local\mw-window-1")에 씀 (MultiWindowExport.h 참고)
+    // maxWidth/maxHeight보다 큰 프레임은 버림. 실패하면 false
+    UNITY_INTERFACE_EXPORT bool EnableFrameExport(void* handle, const char* name, int maxWidth, int maxHeight, int slotCount) {
+        D3D11WindowContext* ctx = g_Windows.Get(handle);
+        if (!ctx) return false;
+        FrameExporter* exporter = new FrameExporter();
+        if (!exporter->Open(name, maxWidth, maxHeight, slotCount)) { delete exporter; return false; }
+        std::lock_guard<std::mutex> lock(ctx->mutex);
+        if (ctx->cmd.exportDirty) delete (FrameExporter*)ctx->cmd.exporter; // 아직 적용 안 된 이전 요청
+        ctx->cmd.exporter = exporter; ctx->cmd.exportDirty = true;
+        return true;
+    }
+    UNITY_INTERFACE_EXPORT void DisableFrameExport(void* handle) {
+        D3D11WindowContext* ctx = g_Windows.Get(handle);
         if (!ctx) return;
         std::lock_guard<std::mutex> lock(ctx->mutex);
-        ctx->cmd.x = x; ctx->cmd.y = y; ctx->cmd.w = w; ctx->cmd.h = h;
-        strncpy_s(ctx->cmd.title, title, 1023);
-        ctx->cmd.borderless = borderless; ctx->cmd.transparent = transparent;
-        ctx->cmd.resizable = resizable; ctx->cmd.hasMinBtn = minBtn; ctx->cmd.hasMaxBtn = maxBtn;
-        ctx->cmd.rectDirty = true; ctx->cmd.titleDirty = true; ctx->cmd.styleDirty = true;
+        if (ctx->cmd.exportDirty) delete (FrameExporter*)ctx->cmd.exporter;
+        ctx->cmd.exporter = nullptr; ctx->cmd.exportDirty = true;
+    }
+    UNITY_INTERFACE_EXPORT void SignalFramesReady(void** handles, int count) {
+        for (int i = 0; i < count; i++) SignalFrameReady(handles[i]);
+    }
+    UNITY_INTERFACE_EXPORT void UpdateTextures(void** handles, void** newPtrs, int count) {
+        for (int i = 0; i < count; i++) UpdateTexture(handles[i], newPtrs[i]);
+    }
+
+    // 트레이스: 켜져 있는 동안 단계별 구간을 기록하고, FlushTrace가 Chrome trace JSON으로 비움
+    UNITY_INTERFACE_EXPORT void SetTraceEnabled(bool enabled) { g_TraceEnabled = enabled; }
+    UNITY_INTERFACE_EXPORT int FlushTrace(const char* path) { return FlushTraceToFile(path); }
+    // 프레젠터 스레드 CPU 고정(cpuMask 비트 = 코어 번호, 0 = 프로세스에 허용된 전체)과 우선순위(RenderThreadPriority)
+    // cpuMask가 허용된 코어와 하나도 안 겹치면 아무것도 바꾸지 않고 false
+    UNITY_INTERFACE_EXPORT bool SetRenderThreadPolicy(void* handle, unsigned long long cpuMask, int priority) {
+        D3D11WindowContext* ctx = g_Windows.Get(handle);
+        if (!ctx) return false;
+        DWORD_PTR processMask = 0, systemMask = 0;
+        GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+        if (cpuMask && !((DWORD_PTR)cpuMask & processMask)) return false; // 허용된 코어와 안 겹침
+        std::lock_guard<std::mutex> lock(ctx->mutex);
+        ctx->cmd.cpuMask = cpuMask; ctx->cmd.priority = priority; ctx->cmd.policyDirty = true;
+        return true;
     }
 }
\ No newline at end of file
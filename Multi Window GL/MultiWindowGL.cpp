@@ -1,4 +1,5 @@
 #include "MultiWindowShared.h"
+#include "MultiWindowTrace.h"
 #include "IUnityInterface.h"
 #include <windows.h>
 #include <gl/GL.h>
@@ -44,8 +45,24 @@ static LRESULT CALLBACK WndProcGL(HWND hWnd, UINT message, WPARAM wParam, LPARAM
     return DefWindowProc(hWnd, message, wParam, lParam);
 }
 
+// 호출한 스레드 자신에게 적용 (렌더 스레드가 명령을 받아서 호출)
+static void ApplyThreadPolicy(unsigned long long cpuMask, int priority) {
+    DWORD_PTR processMask = 0, systemMask = 0;
+    GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+    DWORD_PTR mask = cpuMask ? ((DWORD_PTR)cpuMask & processMask) : processMask;
+    if (mask) SetThreadAffinityMask(GetCurrentThread(), mask);
+
+    int winPriority = THREAD_PRIORITY_NORMAL;
+    if (priority == PRIORITY_ABOVE_NORMAL) winPriority = THREAD_PRIORITY_ABOVE_NORMAL;
+    else if (priority == PRIORITY_HIGH) winPriority = THREAD_PRIORITY_HIGHEST;
+    else if (priority >= PRIORITY_REALTIME) winPriority = THREAD_PRIORITY_TIME_CRITICAL;
+    SetThreadPriority(GetCurrentThread(), winPriority);
+}
+
 static void RenderThreadGL(void* texturePtr, int width, int height) {
+    SetThreadDescription(GetCurrentThread(), L"mw-present-0"); // GL 백엔드는 창 하나
     GLuint texID = (GLuint)(size_t)texturePtr;
+    SourceRect src; // 아틀라스 영역 (기본값 = 텍스처 전체)
 
     WNDCLASSEX wc = { sizeof(WNDCLASSEX), CS_CLASSDC, WndProcGL, 0L, 0L, GetModuleHandle(NULL), NULL, NULL, NULL, NULL, "GLSubWin", NULL };
     RegisterClassEx(&wc);
@@ -70,52 +87,56 @@ static void RenderThreadGL(void* texturePtr, int width, int height) {
         WaitForSingleObject(g_hRenderEvent, 1000);
         if (!g_State.isRunning) break;
 
-        MSG msg;
-        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) { TranslateMessage(&msg); DispatchMessage(&msg); }
-
         {
-            std::lock_guard<std::mutex> lock(g_Mutex);
-            if (g_Cmd.textureDirty) {
-                texID = (GLuint)(size_t)g_Cmd.newTexturePtr;
-                g_Cmd.textureDirty = false;
-            }
-            if (g_Cmd.focusCmdDirty && g_Cmd.setFocus) {
-                SetForegroundWindow(hWnd); SetFocus(hWnd);
-                g_Cmd.focusCmdDirty = false;
-            }
-            if (g_Cmd.styleDirty) {
+            TraceScope trace("DrainEvents", nullptr); // GL 백엔드는 창 하나라 트랙도 하나
+            MSG msg;
+            while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) { TranslateMessage(&msg); DispatchMessage(&msg); }
+        }
+
+        WindowCommand cmd;
+        if (TakeWindowCommand(g_Mutex, g_Cmd, cmd)) {
+            TraceScope trace("ApplyCommand", nullptr);
+            if (cmd.textureDirty) { TraceScope t("TextureSwap", nullptr); texID = (GLuint)(size_t)cmd.newTexturePtr; }
+            if (cmd.policyDirty) ApplyThreadPolicy(cmd.cpuMask, cmd.priority);
+            if (cmd.sourceDirty) src = cmd.source;
+            if (cmd.focusCmdDirty && cmd.setFocus) { SetForegroundWindow(hWnd); SetFocus(hWnd); }
+            if (cmd.styleDirty) {
+                TraceScope t("ApplyStyle", nullptr);
                 LONG_PTR style = GetWindowLongPtr(hWnd, GWL_STYLE);
-                if (g_Cmd.borderless) { style &= ~WS_OVERLAPPEDWINDOW; style |= WS_POPUP; }
+                if (cmd.borderless) { style &= ~WS_OVERLAPPEDWINDOW; style |= WS_POPUP; }
                 else { style |= WS_OVERLAPPEDWINDOW; style &= ~WS_POPUP; }
                 SetWindowLongPtr(hWnd, GWL_STYLE, style);
 
                 // 투명
-                MARGINS m = { g_Cmd.transparent ? -1 : 0 };
+                MARGINS m = { cmd.transparent ? -1 : 0 };
                 DwmExtendFrameIntoClientArea(hWnd, &m);
                 SetWindowPos(hWnd, NULL, 0, 0, 0, 0, SWP_FRAMECHANGED | SWP_NOMOVE | SWP_NOSIZE);
-                g_Cmd.styleDirty = false;
             }
-            if (g_Cmd.rectDirty) {
-                SetWindowPos(hWnd, NULL, g_Cmd.x, g_Cmd.y, g_Cmd.w, g_Cmd.h, SWP_NOZORDER);
-                glViewport(0, 0, g_Cmd.w, g_Cmd.h);
-                g_Cmd.rectDirty = false;
+            if (cmd.rectDirty) {
+                TraceScope t("ApplyRect", nullptr);
+                SetWindowPos(hWnd, NULL, cmd.x, cmd.y, cmd.w, cmd.h, SWP_NOZORDER);
+                glViewport(0, 0, cmd.w, cmd.h);
             }
-            if (g_Cmd.titleDirty) { SetWindowText(hWnd, g_Cmd.title); g_Cmd.titleDirty = false; }
+            if (cmd.titleDirty) { TraceScope t("ApplyTitle", nullptr); SetWindowText(hWnd, cmd.title); }
         }
 
-        // 렌더링 (투명 배경)
-        glClearColor(0, 0, 0, 0);
-        glClear(GL_COLOR_BUFFER_BIT);
-        glEnable(GL_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D, texID);
-        // 좌표계 상하 반전 처리
-        glBegin(GL_QUADS);
-        glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.0f, 1.0f); // Top-Left
-        glTexCoord2f(1.0f, 0.0f); glVertex2f(1.0f, 1.0f); // Top-Right
-        glTexCoord2f(1.0f, 1.0f); glVertex2f(1.0f, -1.0f); // Bottom-Right
-        glTexCoord2f(0.0f, 1.0f); glVertex2f(-1.0f, -1.0f); // Bottom-Left
-        glEnd();
-        SwapBuffers(hDC);
+        {
+            TraceScope trace("Draw", nullptr);
+            // 렌더링 (투명 배경)
+            glClearColor(0, 0, 0, 0);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glEnable(GL_TEXTURE_2D);
+            glBindTexture(GL_TEXTURE_2D, texID);
+            // 좌표계 상하 반전 처리
+            float top = src.flipY ? src.v1 : src.v0, bottom = src.flipY ? src.v0 : src.v1;
+            glBegin(GL_QUADS);
+            glTexCoord2f(src.u0, top); glVertex2f(-1.0f, 1.0f); // Top-Left
+            glTexCoord2f(src.u1, top); glVertex2f(1.0f, 1.0f); // Top-Right
+            glTexCoord2f(src.u1, bottom); glVertex2f(1.0f, -1.0f); // Bottom-Right
+            glTexCoord2f(src.u0, bottom); glVertex2f(-1.0f, -1.0f); // Bottom-Left
+            glEnd();
+        }
+        { TraceScope trace("SwapBuffers", nullptr); SwapBuffers(hDC); }
     }
     wglMakeCurrent(NULL, NULL); wglDeleteContext(hRC); ReleaseDC(hWnd, hDC); DestroyWindow(hWnd);
 }
@@ -140,6 +161,7 @@ extern "C" {
         if (g_hRenderEvent) SetEvent(g_hRenderEvent);
     }
     UNITY_INTERFACE_EXPORT void SignalFrameReady() {
+        TraceScope trace("SignalFrameReady", nullptr);
         if (g_hRenderEvent) SetEvent(g_hRenderEvent);
     }
     UNITY_INTERFACE_EXPORT void SetEventCallback(EventCallbackFunc callback) { g_EventCallback = callback; }
@@ -171,4 +193,23 @@ extern "C" {
         g_Cmd.titleDirty = true;
         g_Cmd.styleDirty = true;
     }
+    // 아틀라스 모드: 원본 텍스처에서 보여줄 영역 (UV 0~1)
+    UNITY_INTERFACE_EXPORT void SetSourceRect(float u0, float v0, float u1, float v1, bool flipY) {
+        std::lock_guard<std::mutex> lock(g_Mutex);
+        g_Cmd.source.u0 = u0; g_Cmd.source.v0 = v0; g_Cmd.source.u1 = u1; g_Cmd.source.v1 = v1;
+        g_Cmd.source.flipY = flipY; g_Cmd.sourceDirty = true;
+    }
+    // 트레이스: 켜져 있는 동안 단계별 구간을 기록하고, FlushTrace가 Chrome trace JSON으로 비움
+    UNITY_INTERFACE_EXPORT void SetTraceEnabled(bool enabled) { g_TraceEnabled = enabled; }
+    UNITY_INTERFACE_EXPORT int FlushTrace(const char* path) { return FlushTraceToFile(path); }
+    // 렌더 스레드 CPU 고정(cpuMask 비트 = 코어 번호, 0 = 프로세스에 허용된 전체)과 우선순위(RenderThreadPriority)
+    // cpuMask가 허용된 코어와 하나도 안 겹치면 아무것도 바꾸지 않고 false
+    UNITY_INTERFACE_EXPORT bool SetRenderThreadPolicy(unsigned long long cpuMask, int priority) {
+        DWORD_PTR processMask = 0, systemMask = 0;
+        GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+        if (cpuMask && !((DWORD_PTR)cpuMask & processMask)) return false; // 허용된 코어와 안 겹침
+        std::lock_guard<std::mutex> lock(g_Mutex);
+        g_Cmd.cpuMask = cpuMask; g_Cmd.priority = priority; g_Cmd.policyDirty = true;
+        return true;
+    }
 }
\ No newline at end of file
@@ -1,36 +1,225 @@
+#define GL_GLEXT_PROTOTYPES // glFenceSync / glWaitSync
 #include "MultiWindowShared.h"
+#include "MultiWindowTrace.h"
+#include "MultiWindowHandles.h"
+#include "MultiWindowExport.h"
 #include "IUnityInterface.h"
+#include "IUnityGraphics.h"
 #include <X11/Xlib.h>
 #include <X11/Xatom.h>
 #include <GL/glx.h>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <string.h>
+#include <stdio.h>
 #include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <dirent.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 
 #define MY_EXPORT __attribute__((visibility("default")))
 
 static GLXContext g_UnityCtx = nullptr; // 공유용 전역 컨텍스트
+static IUnityGraphics* g_Graphics = nullptr;
+static int g_RenderEventID = 0; // ReserveEventIDRange로 받은 값
+static std::mutex g_RenderEventMutex; // StopSubWindow가 진행 중인 렌더 이벤트를 기다리는 용도
+static std::atomic<int> g_NextWindowId{ 0 }; // 스레드 이름용 (mw-present-<id>)
+static const long long FRAME_INTERVAL_NS = 16000000LL; // 스왑 사이 간격 (이 동안 X 연결을 지켜보며 입력을 바로 받음)
+static cpu_set_t g_ProcessAffinity; // 프로세스에 허용된 코어 (taskset, 런처 고정 등). cpuMask 0 = 이 전체
+static bool g_ProcessAffinityValid = false;
 
 struct LinuxWindowContext {
     std::thread renderThread;
     std::mutex mutex;
     bool isRunning = false;
+    int id = 0;
+    void* handle = nullptr; // 유니티에 넘긴 핸들 (콜백/트레이스에 사용)
     WindowCommand cmd;
 
+    // GetRenderEventFunc 모드: 유니티 렌더 스레드가 자기 컨텍스트에 넣은 펜스
+    // 프레젠터는 그리기 전에 GPU 쪽에서만 기다림 (glWaitSync)
+    std::atomic<GLsync> frameFence{ nullptr };
+
+    InputQueue input;
+    std::atomic<long long> lastPresentNs{ 0 }; // glXSwapBuffers 직후 시각 (입력 -> 표시 지연 측정용)
+
     // 콜백
     EventCallbackFunc eventCallback = nullptr;
     CloseCallbackFunc closeCallback = nullptr;
 };
 
+static HandleTable<LinuxWindowContext> g_Windows;
+
 // ... GetARGBVisual 함수 (이전과 동일) ...
 static XVisualInfo* GetARGBVisual(Display* dpy) {
     XVisualInfo templateVis; templateVis.depth = 32; templateVis.c_class = TrueColor; int n;
     return XGetVisualInfo(dpy, VisualDepthMask | VisualClassMask, &templateVis, &n);
 }
 
+// 한 번만 (UnityPluginLoad, 안 불렸으면 첫 StartSubWindow)
+// 리눅스는 affinity가 스레드 단위이고 sched_getaffinity(0)/(getpid())는 호출한 스레드/메인 스레드 것만 돌려줌
+// 그래서 모든 스레드(/proc/self/task) 마스크의 합집합을 씀. taskset 등 프로세스 전체 제한은 모든 스레드에 상속되므로 남고,
+// 유니티가 메인 스레드 같은 특정 스레드만 고정한 것은 프레젠터에 옮겨 오지 않음
+static void CaptureProcessAffinity() {
+    if (g_ProcessAffinityValid) return;
+    CPU_ZERO(&g_ProcessAffinity);
+    DIR* dir = opendir("/proc/self/task");
+    if (dir) {
+        while (dirent* entry = readdir(dir)) {
+            pid_t tid = (pid_t)atoi(entry->d_name);
+            cpu_set_t set;
+            if (tid > 0 && sched_getaffinity(tid, sizeof(set), &set) == 0) { CPU_OR(&g_ProcessAffinity, &g_ProcessAffinity, &set); g_ProcessAffinityValid = true; }
+        }
+        closedir(dir);
+    }
+    if (!g_ProcessAffinityValid) // /proc 없음
+        g_ProcessAffinityValid = sched_getaffinity(0, sizeof(g_ProcessAffinity), &g_ProcessAffinity) == 0;
+}
+
+// cpuMask와 허용된 코어의 교집합. 겹치는 코어가 없으면 false
+static bool ResolveAffinity(unsigned long long cpuMask, cpu_set_t& out) {
+    CPU_ZERO(&out);
+    for (int i = 0; i < CPU_SETSIZE; i++) {
+        if (g_ProcessAffinityValid && !CPU_ISSET(i, &g_ProcessAffinity)) continue;
+        if (!cpuMask || (i < 64 && (cpuMask & (1ULL << i)))) CPU_SET(i, &out);
+    }
+    return CPU_COUNT(&out) > 0;
+}
+
+// 호출한 스레드 자신에게 적용 (프레젠터 스레드가 명령을 받아서 호출)
+static void ApplyThreadPolicy(unsigned long long cpuMask, int priority) {
+    pthread_t self = pthread_self();
+    cpu_set_t set;
+    if (ResolveAffinity(cpuMask, set)) pthread_setaffinity_np(self, sizeof(set), &set); // SetRenderThreadPolicy에서 이미 검사함
+
+    sched_param sp = { 0 };
+    if (priority >= PRIORITY_REALTIME) {
+        sp.sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+        if (pthread_setschedparam(self, SCHED_FIFO, &sp) == 0) return;
+        sp.sched_priority = 0; priority = PRIORITY_HIGH; // CAP_SYS_NICE 없음 -> nice로 대체
+    }
+    pthread_setschedparam(self, SCHED_OTHER, &sp);
+    int nice = priority == PRIORITY_HIGH ? -10 : priority == PRIORITY_ABOVE_NORMAL ? -5 : 0;
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), nice); // 음수 nice는 RLIMIT_NICE가 허용할 때만 적용됨
+}
+
+// X 입력 이벤트 -> InputEvent. 입력 이벤트가 아니면 false
+// XInput2 대신 코어 이벤트 사용 (서버 타임스탬프가 이미 들어 있고 libXi 의존성이 필요 없음)
+static bool TranslateInput(XEvent& xev, InputEvent& e) {
+    e = InputEvent();
+    e.receiveTimeNs = MonotonicNowNs();
+    unsigned int state = 0;
+    switch (xev.type) {
+    case KeyPress: case KeyRelease:
+        e.type = xev.type == KeyPress ? INPUT_KEY_DOWN : INPUT_KEY_UP;
+        e.code = (int)XLookupKeysym(&xev.xkey, 0);
+        e.x = xev.xkey.x; e.y = xev.xkey.y; e.serverTime = (unsigned int)xev.xkey.time; state = xev.xkey.state;
+        break;
+    case ButtonPress: case ButtonRelease: {
+        unsigned int b = xev.xbutton.button;
+        e.x = xev.xbutton.x; e.y = xev.xbutton.y; e.serverTime = (unsigned int)xev.xbutton.time; state = xev.xbutton.state;
+        if (b >= 4 && b <= 7) { // 휠은 버튼 4~7로 들어옴 (누름만 사용)
+            if (xev.type == ButtonRelease) return false;
+            e.type = b <= 5 ? INPUT_WHEEL : INPUT_WHEEL_H;
+            e.code = (b == 4 || b == 7) ? 120 : -120;
+        }
+        else {
+            e.type = xev.type == ButtonPress ? INPUT_BUTTON_DOWN : INPUT_BUTTON_UP;
+            e.code = b == 1 ? 0 : b == 3 ? 1 : b == 2 ? 2 : (int)b - 5; // 8, 9 -> 3, 4
+        }
+        break;
+    }
+    case MotionNotify:
+        e.type = INPUT_MOTION;
+        e.x = xev.xmotion.x; e.y = xev.xmotion.y; e.serverTime = (unsigned int)xev.xmotion.time; state = xev.xmotion.state;
+        break;
+    case EnterNotify: case LeaveNotify:
+        e.type = xev.type == EnterNotify ? INPUT_ENTER : INPUT_LEAVE;
+        e.x = xev.xcrossing.x; e.y = xev.xcrossing.y; e.serverTime = (unsigned int)xev.xcrossing.time; state = xev.xcrossing.state;
+        break;
+    default:
+        return false;
+    }
+    e.modifiers = ((state & ShiftMask) ? INPUT_MOD_SHIFT : 0) | ((state & ControlMask) ? INPUT_MOD_CTRL : 0) | ((state & Mod1Mask) ? INPUT_MOD_ALT : 0);
+    return true;
+}
+
+// 프레임 내보내기용 비동기 읽기. PBO 두 개를 번갈아 쓰고 한 프레임 늦게 맵함
+// 이전 프레임 읽기가 아직 안 끝났으면 기다리지 않고 그 프레임을 버림
+struct GLFrameReadback {
+    GLuint pbo[2] = { 0, 0 };
+    GLsync fence[2] = { nullptr, nullptr };
+    int w[2] = { 0, 0 }, h[2] = { 0, 0 };
+    int index = 0;
+
+    // 백버퍼가 그려진 뒤, 스왑 전에 호출
+    void Capture(FrameExporter* exporter, int width, int height) {
+        int prev = index ^ 1;
+        if (fence[prev]) {
+            GLenum r = glClientWaitSync(fence[prev], 0, 0);
+            glDeleteSync(fence[prev]); fence[prev] = nullptr;
+            if (r == GL_ALREADY_SIGNALED || r == GL_CONDITION_SATISFIED) {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo[prev]);
+                void* src = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+                if (src) {
+                    uint8_t* dst = exporter->BeginWrite((uint32_t)w[prev], (uint32_t)h[prev]);
+                    if (dst) { memcpy(dst, src, (size_t)w[prev] * h[prev] * 4); exporter->EndWrite(FRAME_FLAG_BOTTOM_UP); }
+                    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                }
+            }
+        }
+
+        if (width > 0 && height > 0 && (uint32_t)width <= exporter->MaxWidth() && (uint32_t)height <= exporter->MaxHeight()) {
+            if (!pbo[index]) glGenBuffers(1, &pbo[index]);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo[index]);
+            if (w[index] != width || h[index] != height) {
+                glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, NULL, GL_STREAM_READ);
+                w[index] = width; h[index] = height;
+            }
+            glReadBuffer(GL_BACK); glPixelStorei(GL_PACK_ALIGNMENT, 4);
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+            fence[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        index = prev;
+    }
+
+    void Release() {
+        for (int i = 0; i < 2; i++) {
+            if (fence[i]) { glDeleteSync(fence[i]); fence[i] = nullptr; }
+            if (pbo[i]) { glDeleteBuffers(1, &pbo[i]); pbo[i] = 0; }
+            w[i] = h[i] = 0;
+        }
+        index = 0;
+    }
+};
+
+// 콜백 호출 (트레이스 포함)
+static void DispatchEvent(LinuxWindowContext* ctx, int type, int data1, int data2) {
+    if (!ctx->eventCallback) return;
+    TraceScope trace("EventCallback", ctx->handle);
+    ctx->eventCallback(ctx->handle, type, data1, data2);
+}
+
+static bool DispatchClose(LinuxWindowContext* ctx) {
+    if (!ctx->closeCallback) return true;
+    TraceScope trace("CloseCallback", ctx->handle);
+    return ctx->closeCallback(ctx->handle);
+}
+
 void RenderThreadX11(LinuxWindowContext* ctx, void* texturePtr, int width, int height) {
+    char threadName[16]; snprintf(threadName, sizeof(threadName), "mw-present-%d", ctx->id);
+    pthread_setname_np(pthread_self(), threadName);
+
     GLuint texID = (GLuint)(size_t)texturePtr;
+    SourceRect src; // 아틀라스 영역 (기본값 = 텍스처 전체)
+    int viewW = width, viewH = height; // 현재 드로어블 크기
+    FrameExporter* exporter = nullptr; GLFrameReadback readback;
     Display* dpy = XOpenDisplay(NULL);
     Window root = DefaultRootWindow(dpy);
     XVisualInfo* vi = GetARGBVisual(dpy);
@@ -40,7 +229,8 @@ void RenderThreadX11(LinuxWindowContext* ctx, void* texturePtr, int width, int h
 
     XSetWindowAttributes swa; swa.colormap = XCreateColormap(dpy, root, vi->visual, AllocNone);
     swa.border_pixel = 0; swa.background_pixel = 0;
-    swa.event_mask = StructureNotifyMask | FocusChangeMask | KeyPressMask;
+    swa.event_mask = StructureNotifyMask | FocusChangeMask | KeyPressMask | KeyReleaseMask
+        | ButtonPressMask | ButtonReleaseMask | PointerMotionMask | EnterWindowMask | LeaveWindowMask;
 
     Window win = XCreateWindow(dpy, root, 0, 0, width, height, 0, vi->depth, InputOutput, vi->visual, CWColormap | CWBorderPixel | CWBackPixel | CWEventMask, &swa);
     Atom wmDelete = XInternAtom(dpy, "WM_DELETE_WINDOW", False); XSetWMProtocols(dpy, win, &wmDelete, 1);
@@ -50,97 +240,250 @@ void RenderThreadX11(LinuxWindowContext* ctx, void* texturePtr, int width, int h
     glXMakeCurrent(dpy, win, glCtx);
     ctx->isRunning = true;
 
-    while (ctx->isRunning) {
+    int newW = viewW, newH = viewH; // ConfigureNotify는 드래그 중 연달아 오므로 마지막 크기만 프레임당 한 번 반영
+    auto drainEvents = [&]() {
+        TraceScope trace("DrainEvents", ctx->handle);
         while (XPending(dpy) > 0) {
             XEvent xev;
             XNextEvent(dpy, &xev);
 
+            InputEvent input;
+            if (TranslateInput(xev, input)) { ctx->input.Push(input); continue; }
+
             if (xev.type == ClientMessage && (Atom)xev.xclient.data.l[0] == wmDelete) {
-                if (ctx->closeCallback && !ctx->closeCallback()) continue; // 취소
+                if (!DispatchClose(ctx)) continue; // 취소
                 ctx->isRunning = false;
-                if (ctx->eventCallback) ctx->eventCallback(EVENT_CLOSED, 0, 0);
+                DispatchEvent(ctx, EVENT_CLOSED, 0, 0);
             }
             else if (xev.type == ConfigureNotify) {
-                int w = xev.xconfigure.width; int h = xev.xconfigure.height;
-                glViewport(0, 0, w, h);
-                if (ctx->eventCallback) ctx->eventCallback(EVENT_RESIZED, w, h);
+                newW = xev.xconfigure.width; newH = xev.xconfigure.height;
             }
             else if (xev.type == FocusIn) {
-                if (ctx->eventCallback) ctx->eventCallback(EVENT_FOCUS_GAINED, 0, 0);
+                DispatchEvent(ctx, EVENT_FOCUS_GAINED, 0, 0);
             }
             else if (xev.type == FocusOut) {
-                if (ctx->eventCallback) ctx->eventCallback(EVENT_FOCUS_LOST, 0, 0);
+                DispatchEvent(ctx, EVENT_FOCUS_LOST, 0, 0);
             }
         }
+    };
 
-        {
-            std::lock_guard<std::mutex> lock(ctx->mutex);
-            if (ctx->cmd.textureDirty) {
-                texID = (GLuint)(size_t)ctx->cmd.newTexturePtr;
-                ctx->cmd.textureDirty = false;
-            }
-            if (ctx->cmd.focusCmdDirty && ctx->cmd.setFocus) {
-                XRaiseWindow(dpy, win); XSetInputFocus(dpy, win, RevertToParent, CurrentTime);
-                ctx->cmd.focusCmdDirty = false;
-            }
-            if (ctx->cmd.rectDirty) {
-                XMoveResizeWindow(dpy, win, ctx->cmd.x, ctx->cmd.y, ctx->cmd.w, ctx->cmd.h);
-                ctx->cmd.rectDirty = false;
-            }
-            if (ctx->cmd.titleDirty) { XStoreName(dpy, win, ctx->cmd.title); ctx->cmd.titleDirty = false; }
-            if (ctx->cmd.styleDirty) {
+    while (ctx->isRunning) {
+        drainEvents();
+        if (newW != viewW || newH != viewH) {
+            // 새 크기 프레임이 올 때까지는 이전 텍스처가 새 뷰포트에 맞춰 늘어나서 그려짐
+            viewW = newW; viewH = newH;
+            glViewport(0, 0, viewW, viewH);
+            DispatchEvent(ctx, EVENT_RESIZED, viewW, viewH);
+        }
+
+        WindowCommand cmd;
+        if (TakeWindowCommand(ctx->mutex, ctx->cmd, cmd)) {
+            TraceScope trace("ApplyCommand", ctx->handle);
+            if (cmd.textureDirty) { TraceScope t("TextureSwap", ctx->handle); texID = (GLuint)(size_t)cmd.newTexturePtr; }
+            if (cmd.policyDirty) ApplyThreadPolicy(cmd.cpuMask, cmd.priority);
+            if (cmd.sourceDirty) src = cmd.source;
+            if (cmd.exportDirty) { readback.Release(); delete exporter; exporter = (FrameExporter*)cmd.exporter; }
+            if (cmd.focusCmdDirty && cmd.setFocus) { XRaiseWindow(dpy, win); XSetInputFocus(dpy, win, RevertToParent, CurrentTime); }
+            if (cmd.rectDirty) { TraceScope t("ApplyRect", ctx->handle); XMoveResizeWindow(dpy, win, cmd.x, cmd.y, cmd.w, cmd.h); }
+            if (cmd.titleDirty) { TraceScope t("ApplyTitle", ctx->handle); XStoreName(dpy, win, cmd.title); }
+            if (cmd.styleDirty) {
+                TraceScope t("ApplyStyle", ctx->handle);
                 struct MwmHints { unsigned long flags, functions, decorations; long input_mode; unsigned long status; };
-                MwmHints hints = { 0 }; hints.flags = 2; hints.decorations = ctx->cmd.borderless ? 0 : 1;
+                MwmHints hints = { 0 }; hints.flags = 2; hints.decorations = cmd.borderless ? 0 : 1;
                 XChangeProperty(dpy, win, wmHints, wmHints, 32, PropModeReplace, (unsigned char*)&hints, 5);
-                ctx->cmd.styleDirty = false;
             }
         }
 
-        glClearColor(0, 0, 0, 0); glClear(GL_COLOR_BUFFER_BIT);
-        glEnable(GL_TEXTURE_2D); glBindTexture(GL_TEXTURE_2D, texID);
-        glBegin(GL_QUADS);
-        glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.0f, 1.0f);
-        glTexCoord2f(1.0f, 0.0f); glVertex2f(1.0f, 1.0f);
-        glTexCoord2f(1.0f, 1.0f); glVertex2f(1.0f, -1.0f);
-        glTexCoord2f(0.0f, 1.0f); glVertex2f(-1.0f, -1.0f);
-        glEnd();
-        glXSwapBuffers(dpy, win);
-        usleep(16000);
+        GLsync fence = ctx->frameFence.exchange(nullptr);
+        if (fence) { glWaitSync(fence, 0, GL_TIMEOUT_IGNORED); glDeleteSync(fence); }
+
+        {
+            TraceScope trace("Draw", ctx->handle);
+            glClearColor(0, 0, 0, 0); glClear(GL_COLOR_BUFFER_BIT);
+            glEnable(GL_TEXTURE_2D); glBindTexture(GL_TEXTURE_2D, texID);
+            float top = src.flipY ? src.v1 : src.v0, bottom = src.flipY ? src.v0 : src.v1;
+            glBegin(GL_QUADS);
+            glTexCoord2f(src.u0, top); glVertex2f(-1.0f, 1.0f);
+            glTexCoord2f(src.u1, top); glVertex2f(1.0f, 1.0f);
+            glTexCoord2f(src.u1, bottom); glVertex2f(1.0f, -1.0f);
+            glTexCoord2f(src.u0, bottom); glVertex2f(-1.0f, -1.0f);
+            glEnd();
+        }
+        if (exporter) { TraceScope trace("ExportReadback", ctx->handle); readback.Capture(exporter, viewW, viewH); }
+        { TraceScope trace("SwapBuffers", ctx->handle); glXSwapBuffers(dpy, win); }
+        ctx->lastPresentNs = MonotonicNowNs();
+
+        // 다음 스왑까지 X 연결을 지켜보다가 이벤트가 오면 바로 처리 (입력이 최대 한 프레임 늦게 큐에 들어가지 않도록)
+        long long deadline = ctx->lastPresentNs + FRAME_INTERVAL_NS;
+        while (ctx->isRunning) {
+            long long remaining = deadline - MonotonicNowNs();
+            if (remaining <= 0) break;
+            if (XPending(dpy) == 0) { // Xlib 큐에 이미 읽어 둔 이벤트가 있으면 poll이 깨우지 못하므로 먼저 확인 (요청도 같이 보냄)
+                pollfd pfd = { ConnectionNumber(dpy), POLLIN, 0 };
+                int r = poll(&pfd, 1, (int)((remaining + 999999) / 1000000));
+                if (r == 0) break;
+                if (r < 0) continue; // EINTR
+            }
+            drainEvents();
+        }
     }
     // 정리
+    readback.Release(); delete exporter;
+    GLsync fence = ctx->frameFence.exchange(nullptr);
+    if (fence) glDeleteSync(fence);
+}
+
+// 유니티 렌더 스레드에서 실행 (CommandBuffer.IssuePluginEventAndData(GetRenderEventFunc(), GetRenderEventID(), handle))
+// 유니티가 텍스처를 다 그린 지점에 펜스를 넣어서, 프레젠터가 덜 그려진 텍스처를 읽지 않게 함
+static void UNITY_INTERFACE_API OnRenderEvent(int eventId, void* data) {
+    if (eventId != g_RenderEventID) return;
+    std::lock_guard<std::mutex> eventLock(g_RenderEventMutex);
+    LinuxWindowContext* ctx = g_Windows.Get(data);
+    if (!ctx || !ctx->isRunning) return;
+    TraceScope trace("RenderEventFence", ctx->handle);
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush(); // 다른 컨텍스트에서 기다리려면 펜스가 제출돼 있어야 함
+    GLsync old = ctx->frameFence.exchange(fence);
+    if (old) glDeleteSync(old); // 프레젠터가 아직 안 가져간 이전 프레임 펜스
+}
+
+static void UNITY_INTERFACE_API OnGraphicsDeviceEvent(UnityGfxDeviceEventType eventType) {
+    if (eventType == kUnityGfxDeviceEventInitialize) {
+        GLXContext current = glXGetCurrentContext(); // 렌더 스레드에서 불리므로 유니티 컨텍스트
+        if (current) g_UnityCtx = current;
+    }
+    else if (eventType == kUnityGfxDeviceEventShutdown) {
+        g_UnityCtx = nullptr;
+    }
 }
 
 extern "C" {
-    UNITY_INTERFACE_EXPORT void UnityPluginLoad(IUnityInterfaces* i) { g_UnityCtx = glXGetCurrentContext(); }
+    UNITY_INTERFACE_EXPORT void UnityPluginLoad(IUnityInterfaces* i) {
+        g_Graphics = i->Get<IUnityGraphics>();
+        if (g_Graphics) {
+            g_RenderEventID = g_Graphics->ReserveEventIDRange(1);
+            g_Graphics->RegisterDeviceEventCallback(OnGraphicsDeviceEvent);
+        }
+        // 디바이스가 이미 만들어진 뒤에 로드되면 Initialize 이벤트를 놓치므로 직접 호출
+        OnGraphicsDeviceEvent(kUnityGfxDeviceEventInitialize);
+        CaptureProcessAffinity();
+    }
+    UNITY_INTERFACE_EXPORT void UnityPluginUnload() {
+        if (g_Graphics) g_Graphics->UnregisterDeviceEventCallback(OnGraphicsDeviceEvent);
+    }
+
+    UNITY_INTERFACE_EXPORT UnityRenderingEventAndData GetRenderEventFunc() { return OnRenderEvent; }
+    UNITY_INTERFACE_EXPORT int GetRenderEventID() { return g_RenderEventID; }
 
     // [인스턴스 생성]
     UNITY_INTERFACE_EXPORT void* StartSubWindow(void* texturePtr, int w, int h) {
+        CaptureProcessAffinity();
         LinuxWindowContext* ctx = new LinuxWindowContext();
+        ctx->handle = g_Windows.Add(ctx);
+        if (!ctx->handle) { delete ctx; return nullptr; } // 테이블 가득 참
+        ctx->id = g_NextWindowId++;
         ctx->isRunning = true;
         ctx->renderThread = std::thread(RenderThreadX11, ctx, texturePtr, w, h);
-        return (void*)ctx;
+        return ctx->handle;
     }
 
     // [인스턴스 파괴]
     UNITY_INTERFACE_EXPORT void StopSubWindow(void* handle) {
-        LinuxWindowContext* ctx = (LinuxWindowContext*)handle;
+        LinuxWindowContext* ctx = g_Windows.Remove(handle); // 이후 같은 핸들로 오는 호출은 모두 무시됨
         if (!ctx) return;
         ctx->isRunning = false;
         if (ctx->renderThread.joinable()) ctx->renderThread.join();
+        if (ctx->cmd.exportDirty) delete (FrameExporter*)ctx->cmd.exporter; // 프레젠터가 못 가져간 것
+        { std::lock_guard<std::mutex> eventLock(g_RenderEventMutex); } // 렌더 스레드에서 이 창을 쓰는 중이면 끝날 때까지
         delete ctx;
     }
 
     // 모든 Setter 함수에 handle 추가 (D3D11과 동일하게 구현)
-    UNITY_INTERFACE_EXPORT void SignalFrameReady(void* handle) {}
-    UNITY_INTERFACE_EXPORT void SetEventCallback(void* handle, EventCallbackFunc cb) { ((LinuxWindowContext*)handle)->eventCallback = cb; }
-    UNITY_INTERFACE_EXPORT void SetCloseCallback(void* handle, CloseCallbackFunc cb) { ((LinuxWindowContext*)handle)->closeCallback = cb; }
+    UNITY_INTERFACE_EXPORT void SignalFrameReady(void* handle) { TraceScope trace("SignalFrameReady", handle); }
+    UNITY_INTERFACE_EXPORT void SetEventCallback(void* handle, EventCallbackFunc cb) { LinuxWindowContext* c = g_Windows.Get(handle); if (c) c->eventCallback = cb; }
+    UNITY_INTERFACE_EXPORT void SetCloseCallback(void* handle, CloseCallbackFunc cb) { LinuxWindowContext* c = g_Windows.Get(handle); if (c) c->closeCallback = cb; }
     UNITY_INTERFACE_EXPORT void UpdateTexture(void* handle, void* ptr) {
-        LinuxWindowContext* c = (LinuxWindowContext*)handle; std::lock_guard<std::mutex> l(c->mutex); c->cmd.newTexturePtr = ptr; c->cmd.textureDirty = true;
+        LinuxWindowContext* c = g_Windows.Get(handle); if (!c) return;
+        std::lock_guard<std::mutex> l(c->mutex); c->cmd.newTexturePtr = ptr; c->cmd.textureDirty = true;
+    }
+    UNITY_INTERFACE_EXPORT void FocusWindow(void* handle) {
+        LinuxWindowContext* c = g_Windows.Get(handle); if (!c) return;
+        std::lock_guard<std::mutex> l(c->mutex); c->cmd.setFocus = true; c->cmd.focusCmdDirty = true;
     }
-    UNITY_INTERFACE_EXPORT void FocusWindow(void* handle) { /* ... */ }
     UNITY_INTERFACE_EXPORT void SetConfig(void* handle, int x, int y, int w, int h, const char* title, bool b, bool t, bool r, bool min, bool max) {
-        LinuxWindowContext* c = (LinuxWindowContext*)handle; std::lock_guard<std::mutex> l(c->mutex);
-        c->cmd.x = x; c->cmd.y = y; c->cmd.w = w; c->cmd.h = h; strcpy(c->cmd.title, title);
-        c->cmd.rectDirty = true; /* ... */
+        LinuxWindowContext* c = g_Windows.Get(handle); if (!c) return;
+        WindowConfig config = { x, y, w, h, title, b, t, r, min, max };
+        std::lock_guard<std::mutex> l(c->mutex); ApplyWindowConfig(c->cmd, config);
+    }
+
+    // 일괄 호출: 창 여러 개를 P/Invoke 한 번으로 처리. 잘못된(닫힌) 핸들은 건너뜀
+    UNITY_INTERFACE_EXPORT void SetConfigBatch(void** handles, const WindowConfig* configs, int count) {
+        for (int i = 0; i < count; i++) {
+            LinuxWindowContext* c = g_Windows.Get(handles[i]); if (!c) continue;
+            std::lock_guard<std::mutex> l(c->mutex); ApplyWindowConfig(c->cmd, configs[i]);
+        }
+    }
+    // 아틀라스 모드: 원본 텍스처에서 보여줄 영역 (UV 0~1). 같은 텍스처를 여러 창에 넘기고 영역만 다르게 주면 됨
+    UNITY_INTERFACE_EXPORT void SetSourceRect(void* handle, float u0, float v0, float u1, float v1, bool flipY) {
+        LinuxWindowContext* c = g_Windows.Get(handle); if (!c) return;
+        std::lock_guard<std::mutex> l(c->mutex);
+        c->cmd.source.u0 = u0; c->cmd.source.v0 = v0; c->cmd.source.u1 = u1; c->cmd.source.v1 = v1;
+        c->cmd.source.flipY = flipY; c->cmd.sourceDirty = true;
+    }
+    UNITY_INTERFACE_EXPORT void SetSourceRectBatch(void** handles, const SourceRect* rects, int count) {
+        for (int i = 0; i < count; i++) {
+            LinuxWindowContext* c = g_Windows.Get(handles[i]); if (!c) continue;
+            std::lock_guard<std::mutex> l(c->mutex); c->cmd.source = rects[i]; c->cmd.sourceDirty = true;
+        }
+    }
+    // 입력: 유니티가 프레임당 한 번 비움. 반환값 = out에 채운 개수
+    UNITY_INTERFACE_EXPORT int PollInputEvents(void* handle, InputEvent* out, int maxCount) {
+        LinuxWindowContext* c = g_Windows.Get(handle); if (!c) return 0;
+        return c->input.Drain(out, maxCount);
+    }
+    // 기본값 true: PollInputEvents 한 번에 연속된 모션은 마지막 것만 돌려줌. false면 모든 모션 이벤트를 그대로 보냄
+    UNITY_INTERFACE_EXPORT void SetInputMotionCoalescing(void* handle, bool enabled) {
+        LinuxWindowContext* c = g_Windows.Get(handle); if (c) c->input.coalesceMotion = enabled;
+    }
+    // InputEvent.receiveTimeNs와 같은 시계
+    UNITY_INTERFACE_EXPORT long long GetNativeTime() { return MonotonicNowNs(); }
+    UNITY_INTERFACE_EXPORT long long GetLastPresentTime(void* handle) {
+        LinuxWindowContext* c = g_Windows.Get(handle); return c ? c->lastPresentNs.load() : 0;
+    }
+    // 프레임 내보내기: 표시되는 프레임을 POSIX 공유 메모리 링(name, 예: "/mw-window-1")에 씀 (MultiWindowExport.h 참고)
+    // maxWidth/maxHeight보다 큰 프레임은 버림. 실패하면 false
+    UNITY_INTERFACE_EXPORT bool EnableFrameExport(void* handle, const char* name, int maxWidth, int maxHeight, int slotCount) {
+        LinuxWindowContext* c = g_Windows.Get(handle); if (!c) return false;
+        FrameExporter* exporter = new FrameExporter();
+        if (!exporter->Open(name, maxWidth, maxHeight, slotCount)) { delete exporter; return false; }
+        std::lock_guard<std::mutex> l(c->mutex);
+        if (c->cmd.exportDirty) delete (FrameExporter*)c->cmd.exporter; // 아직 적용 안 된 이전 요청
+        c->cmd.exporter = exporter; c->cmd.exportDirty = true;
+        return true;
+    }
+    UNITY_INTERFACE_EXPORT void DisableFrameExport(void* handle) {
+        LinuxWindowContext* c = g_Windows.Get(handle); if (!c) return;
+        std::lock_guard<std::mutex> l(c->mutex);
+        if (c->cmd.exportDirty) delete (FrameExporter*)c->cmd.exporter;
+        c->cmd.exporter = nullptr; c->cmd.exportDirty = true;
+    }
+    UNITY_INTERFACE_EXPORT void SignalFramesReady(void** handles, int count) {
+        for (int i = 0; i < count; i++) SignalFrameReady(handles[i]);
+    }
+    UNITY_INTERFACE_EXPORT void UpdateTextures(void** handles, void** ptrs, int count) {
+        for (int i = 0; i < count; i++) UpdateTexture(handles[i], ptrs[i]);
+    }
+    // 트레이스: 켜져 있는 동안 단계별 구간을 기록하고, FlushTrace가 Chrome trace JSON으로 비움
+    UNITY_INTERFACE_EXPORT void SetTraceEnabled(bool enabled) { g_TraceEnabled = enabled; }
+    UNITY_INTERFACE_EXPORT int FlushTrace(const char* path) { return FlushTraceToFile(path); }
+    // 프레젠터 스레드 CPU 고정(cpuMask 비트 = 코어 번호, 0 = 프로세스에 허용된 전체)과 우선순위(RenderThreadPriority)
+    // cpuMask가 허용된 코어와 하나도 안 겹치면 아무것도 바꾸지 않고 false
+    UNITY_INTERFACE_EXPORT bool SetRenderThreadPolicy(void* handle, unsigned long long cpuMask, int priority) {
+        LinuxWindowContext* c = g_Windows.Get(handle); if (!c) return false;
+        cpu_set_t set;
+        if (!ResolveAffinity(cpuMask, set)) return false;
+        std::lock_guard<std::mutex> l(c->mutex);
+        c->cmd.cpuMask = cpuMask; c->cmd.priority = priority; c->cmd.policyDirty = true;
+        return true;
     }
 }
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+#include "MultiWindowShared.h"
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// 프레임 내보내기: 표시된 프레임을 이름 있는 공유 메모리 링에 씀 (Linux: shm_open, Windows: 이름 있는 파일 매핑)
+// 외부 프로세스(인코더, 녹화기)가 유니티를 거치지 않고 읽어 감. 읽는 쪽이 느려도 쓰는 쪽은 기다리지 않음 (덮어씀)
+//
+// 레이아웃: [FrameExportHeader][슬롯 0][슬롯 1]... 슬롯 = FrameSlotHeader + 픽셀 (RGBA8, slotStride 간격)
+// 읽는 쪽:
+//   seq = latestSeq; slot = seq % slotCount
+//   s1 = slot.seqlock (짝수여야 함) -> 픽셀 복사 -> s2 = slot.seqlock
+//   s1 == s2 이고 slot.frameSeq == seq 이면 유효, 아니면 버리고 다시
+
+static const uint32_t FRAME_EXPORT_MAGIC = 0x5846574D; // "MWFX"
+static const uint32_t FRAME_EXPORT_VERSION = 1;
+static const uint32_t FRAME_FLAG_BOTTOM_UP = 1; // 행 순서가 아래 -> 위 (GL glReadPixels)
+
+struct FrameExportHeader {
+    uint32_t magic, version;
+    uint32_t slotCount, slotStride; // slotStride = 슬롯 하나의 바이트 수 (헤더 포함)
+    uint32_t maxWidth, maxHeight;
+    std::atomic<uint64_t> latestSeq; // 마지막으로 다 쓴 프레임 번호 (0 = 아직 없음)
+};
+
+struct FrameSlotHeader {
+    std::atomic<uint32_t> seqlock; // 홀수 = 쓰는 중
+    uint32_t width, height, rowPitch, flags;
+    uint32_t reserved;
+    uint64_t frameSeq;
+    int64_t timestampNs; // MonotonicNowNs
+};
+
+class FrameExporter {
+    uint8_t* base = nullptr;
+    size_t size = 0;
+    uint64_t nextSeq = 1;
+    uint8_t* writing = nullptr;
+#ifdef _WIN32
+    HANDLE mapping = NULL;
+#else
+    char shmName[256] = { 0 };
+    ino_t inode = 0; // 같은 이름으로 새로 만든 링을 지우지 않도록 확인용
+#endif
+
+    FrameExportHeader* Header() const { return (FrameExportHeader*)base; }
+    uint8_t* Slot(uint32_t i) const { return base + sizeof(FrameExportHeader) + (size_t)i * Header()->slotStride; }
+
+public:
+    uint32_t MaxWidth() const { return base ? Header()->maxWidth : 0; }
+    uint32_t MaxHeight() const { return base ? Header()->maxHeight : 0; }
+
+    bool Open(const char* name, int maxWidth, int maxHeight, int slotCount) {
+        if (!name || maxWidth <= 0 || maxHeight <= 0 || slotCount <= 0) return false;
+        // 64비트로 계산. 슬롯 하나가 헤더의 slotStride(uint32)를 넘거나 전체가 size_t를 넘으면 거부
+        uint64_t stride64 = (sizeof(FrameSlotHeader) + (uint64_t)maxWidth * (uint64_t)maxHeight * 4 + 63) & ~(uint64_t)63;
+        if (stride64 > UINT32_MAX) return false;
+        uint64_t size64 = sizeof(FrameExportHeader) + stride64 * (uint64_t)slotCount;
+        if (size64 > (uint64_t)SIZE_MAX) return false;
+        uint32_t slotStride = (uint32_t)stride64;
+        size = (size_t)size64;
+#ifdef _WIN32
+        mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((unsigned long long)size >> 32), (DWORD)size, name);
+        if (!mapping) return false;
+        base = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        if (!base) { CloseHandle(mapping); mapping = NULL; return false; }
+#else
+        size_t n = strlen(name); if (n > sizeof(shmName) - 1) n = sizeof(shmName) - 1;
+        memcpy(shmName, name, n); shmName[n] = 0;
+        shm_unlink(shmName); // 이전 링을 읽던 쪽은 그대로 두고 새 객체를 만듦
+        int fd = shm_open(shmName, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) return false;
+        struct stat st; if (fstat(fd, &st) == 0) inode = st.st_ino;
+        if (ftruncate(fd, (off_t)size) != 0) { close(fd); shm_unlink(shmName); return false; }
+        void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) { shm_unlink(shmName); return false; }
+        base = (uint8_t*)p;
+#endif
+        FrameExportHeader* h = Header();
+        h->magic = 0; // 같은 이름이 남아 있었을 수 있으므로 초기화가 끝날 때까지 무효 표시
+        h->version = FRAME_EXPORT_VERSION;
+        h->slotCount = (uint32_t)slotCount; h->slotStride = slotStride;
+        h->maxWidth = (uint32_t)maxWidth; h->maxHeight = (uint32_t)maxHeight;
+        h->latestSeq.store(0, std::memory_order_relaxed);
+        for (int i = 0; i < slotCount; i++) ((FrameSlotHeader*)Slot(i))->seqlock.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        h->magic = FRAME_EXPORT_MAGIC; // 마지막에 써서 읽는 쪽이 초기화 완료를 알 수 있게 함
+        return true;
+    }
+
+    ~FrameExporter() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+#else
+        if (!base) return;
+        munmap(base, size);
+        int fd = shm_open(shmName, O_RDONLY, 0);
+        if (fd >= 0) {
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_ino == inode) shm_unlink(shmName);
+            close(fd);
+        }
+#endif
+    }
+
+    // 다음 슬롯의 픽셀 위치를 돌려줌 (행 간격 = width * 4). 최대 크기보다 크면 nullptr (프레임 버림)
+    uint8_t* BeginWrite(uint32_t width, uint32_t height) {
+        if (!base || width > Header()->maxWidth || height > Header()->maxHeight) return nullptr;
+        if ((uint64_t)width * height * 4 > Header()->slotStride - sizeof(FrameSlotHeader)) return nullptr;
+        writing = Slot((uint32_t)(nextSeq % Header()->slotCount));
+        FrameSlotHeader* slot = (FrameSlotHeader*)writing;
+        slot->seqlock.store(slot->seqlock.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot->width = width; slot->height = height; slot->rowPitch = width * 4;
+        return writing + sizeof(FrameSlotHeader);
+    }
+
+    void EndWrite(uint32_t flags) {
+        if (!writing) return;
+        FrameSlotHeader* slot = (FrameSlotHeader*)writing;
+        slot->flags = flags; slot->frameSeq = nextSeq; slot->timestampNs = MonotonicNowNs();
+        slot->seqlock.store(slot->seqlock.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        Header()->latestSeq.store(nextSeq, std::memory_order_release);
+        nextSeq++;
+        writing = nullptr;
+    }
+};
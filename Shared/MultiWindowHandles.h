@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+
+// 슬롯맵 핸들 테이블. 유니티에 넘기는 핸들 = (세대 << 16) | (슬롯 + 1)
+// StopSubWindow로 지워진 핸들은 세대가 달라져서 Get이 nullptr를 반환함 (O(1), 잠금 없음)
+// 32비트 빌드에서도 void*에 들어가도록 슬롯/세대를 16비트씩 사용
+template <typename T, unsigned int Capacity = 1024>
+class HandleTable {
+    static_assert(Capacity < 0xFFFF, "slot index must fit in 16 bits");
+
+    struct Slot {
+        std::atomic<T*> ptr{ nullptr };
+        std::atomic<unsigned int> generation{ 1 };
+    };
+    Slot slots[Capacity];
+    std::mutex allocMutex; // Add/Remove 전용
+    unsigned int freeSlots[Capacity];
+    unsigned int freeCount = Capacity;
+
+public:
+    HandleTable() { for (unsigned int i = 0; i < Capacity; i++) freeSlots[i] = Capacity - 1 - i; }
+
+    void* Add(T* p) {
+        std::lock_guard<std::mutex> lock(allocMutex);
+        if (freeCount == 0) return nullptr;
+        unsigned int index = freeSlots[--freeCount];
+        slots[index].ptr.store(p, std::memory_order_release);
+        uintptr_t gen = slots[index].generation.load(std::memory_order_relaxed) & 0xFFFF;
+        return (void*)((gen << 16) | (uintptr_t)(index + 1));
+    }
+
+    T* Get(void* handle) const {
+        uintptr_t h = (uintptr_t)handle;
+        unsigned int index = (unsigned int)(h & 0xFFFF) - 1;
+        if (index >= Capacity) return nullptr;
+        const Slot& s = slots[index];
+        if ((s.generation.load(std::memory_order_acquire) & 0xFFFF) != ((h >> 16) & 0xFFFF)) return nullptr;
+        return s.ptr.load(std::memory_order_acquire);
+    }
+
+    // 슬롯을 비우고 포인터를 돌려줌 (delete는 호출자가)
+    T* Remove(void* handle) {
+        std::lock_guard<std::mutex> lock(allocMutex);
+        T* p = Get(handle);
+        if (!p) return nullptr;
+        unsigned int index = (unsigned int)((uintptr_t)handle & 0xFFFF) - 1;
+        slots[index].ptr.store(nullptr, std::memory_order_release);
+        unsigned int gen = (slots[index].generation.load(std::memory_order_relaxed) + 1) & 0xFFFF;
+        slots[index].generation.store(gen ? gen : 1, std::memory_order_release);
+        freeSlots[freeCount++] = index;
+        return p;
+    }
+};
@@ -1,4 +1,8 @@
 #pragma once
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string.h>
 
 enum NativeEventType {
     EVENT_CLOSED = 0, EVENT_MOVED = 1, EVENT_RESIZED = 2,
@@ -6,9 +10,40 @@ enum NativeEventType {
     EVENT_MINIMIZED = 5, EVENT_MAXIMIZED = 6, EVENT_RESTORED = 7
 };
 
+// 프레젠터 스레드 우선순위 (SetRenderThreadPolicy)
+enum RenderThreadPriority {
+    PRIORITY_NORMAL = 0, PRIORITY_ABOVE_NORMAL = 1, PRIORITY_HIGH = 2,
+    PRIORITY_REALTIME = 3 // Linux: SCHED_FIFO (권한 없으면 HIGH로 대체), Windows: TIME_CRITICAL
+};
+
+// 입력 이벤트 (PollInputEvents)
+enum NativeInputType {
+    INPUT_KEY_DOWN = 0, INPUT_KEY_UP = 1,
+    INPUT_BUTTON_DOWN = 2, INPUT_BUTTON_UP = 3,
+    INPUT_MOTION = 4, INPUT_WHEEL = 5, INPUT_WHEEL_H = 6,
+    INPUT_ENTER = 7, INPUT_LEAVE = 8
+};
+enum NativeInputModifier { INPUT_MOD_SHIFT = 1, INPUT_MOD_CTRL = 2, INPUT_MOD_ALT = 4 };
+
+struct InputEvent {
+    int type;       // NativeInputType
+    int code;       // 키: X KeySym / Windows VK, 버튼: 0 왼쪽 1 오른쪽 2 가운데 3~4 보조, 휠: 120 단위 (+ = 위/오른쪽)
+    int x, y;       // 창 클라이언트 좌표
+    int modifiers;  // NativeInputModifier 비트
+    unsigned int serverTime;  // X 서버 시간 / GetMessageTime (ms)
+    long long receiveTimeNs;  // 플러그인이 받은 시각 (MonotonicNowNs, GetLastPresentTime과 같은 시계)
+};
+
 typedef void (*EventCallbackFunc)(void* handle, int type, int data1, int data2);
 typedef bool (*CloseCallbackFunc)(void* handle);
 
+// 아틀라스 모드: 원본 텍스처에서 이 창이 보여줄 영역 (UV 0~1, 왼쪽 위 -> 오른쪽 아래)
+// 여러 창이 한 RenderTexture의 서로 다른 영역을 나눠 쓸 수 있음. flipY는 상하 반전
+struct SourceRect {
+    float u0 = 0.0f, v0 = 0.0f, u1 = 1.0f, v1 = 1.0f;
+    int flipY = 0;
+};
+
 struct WindowCommand {
     bool rectDirty = false; int x, y, w, h;
     bool titleDirty = false; char title[1024];
@@ -16,4 +51,113 @@ struct WindowCommand {
     bool resizable = true; bool hasMinBtn = true; bool hasMaxBtn = true;
     bool focusCmdDirty = false; bool setFocus = false;
     bool textureDirty = false; void* newTexturePtr = nullptr;
-};
\ No newline at end of file
+    bool policyDirty = false; unsigned long long cpuMask = 0; int priority = PRIORITY_NORMAL; // cpuMask 0 = 프로세스에 허용된 모든 코어
+    bool sourceDirty = false; SourceRect source;
+    bool exportDirty = false; void* exporter = nullptr; // FrameExporter (소유권이 프레젠터로 넘어감, nullptr = 끄기)
+
+    bool AnyDirty() const { return rectDirty || titleDirty || styleDirty || focusCmdDirty || textureDirty || policyDirty || sourceDirty || exportDirty; }
+};
+
+// SetConfig / SetConfigBatch 인자 (C#에서 그대로 blittable 하도록 bool 대신 int)
+// title이 nullptr면 제목은 건드리지 않음
+struct WindowConfig {
+    int x, y, w, h;
+    const char* title;
+    int borderless, transparent, resizable, hasMinBtn, hasMaxBtn;
+};
+
+// 호출자가 명령 mutex를 잡은 상태에서 호출
+inline void ApplyWindowConfig(WindowCommand& cmd, const WindowConfig& c) {
+    cmd.x = c.x; cmd.y = c.y; cmd.w = c.w; cmd.h = c.h; cmd.rectDirty = true;
+    if (c.title) {
+        size_t n = strlen(c.title); if (n > sizeof(cmd.title) - 1) n = sizeof(cmd.title) - 1;
+        memcpy(cmd.title, c.title, n); cmd.title[n] = 0;
+        cmd.titleDirty = true;
+    }
+    cmd.borderless = c.borderless != 0; cmd.transparent = c.transparent != 0;
+    cmd.resizable = c.resizable != 0; cmd.hasMinBtn = c.hasMinBtn != 0; cmd.hasMaxBtn = c.hasMaxBtn != 0;
+    cmd.styleDirty = true;
+}
+
+// 대기 중인 명령을 잠금 안에서 복사만 하고 dirty 플래그를 내림
+// 실제 OS/X 호출은 잠금 밖에서 하므로 윈도우 매니저가 멈춰도 Setter를 부르는 유니티 메인 스레드는 막히지 않음
+inline bool TakeWindowCommand(std::mutex& mutex, WindowCommand& pending, WindowCommand& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!pending.AnyDirty()) return false;
+    out = pending;
+    pending.rectDirty = false; pending.titleDirty = false; pending.styleDirty = false;
+    pending.focusCmdDirty = false; pending.textureDirty = false; pending.policyDirty = false;
+    pending.sourceDirty = false; pending.exportDirty = false; pending.exporter = nullptr;
+    return true;
+}
+
+// 텍스처/영역 명령만 가져가고 나머지(창 위치, 스타일 등)는 남겨 둠
+// 창 드래그 중 모달 루프 안에서 사용 (그때 SetWindowPos 등을 부르면 드래그와 충돌)
+inline bool TakeFrameCommand(std::mutex& mutex, WindowCommand& pending, WindowCommand& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!pending.textureDirty && !pending.sourceDirty) return false;
+    out.textureDirty = pending.textureDirty; out.newTexturePtr = pending.newTexturePtr;
+    out.sourceDirty = pending.sourceDirty; out.source = pending.source;
+    pending.textureDirty = false; pending.sourceDirty = false;
+    return true;
+}
+
+
+inline long long MonotonicNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 단일 생산자/단일 소비자 락프리 링 (N은 2의 거듭제곱). 가득 차면 Push가 false를 반환하고 버림
+template <typename T, unsigned int N>
+struct SpscRing {
+    static_assert((N & (N - 1)) == 0, "N must be a power of two");
+    T items[N];
+    std::atomic<unsigned int> head{ 0 }; // 생산자만 씀
+    std::atomic<unsigned int> tail{ 0 }; // 소비자만 씀
+
+    bool Push(const T& v) {
+        unsigned int h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) return false;
+        items[h & (N - 1)] = v;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    bool Peek(T& out) const {
+        unsigned int t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        out = items[t & (N - 1)];
+        return true;
+    }
+    bool Pop(T& out) {
+        unsigned int t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        out = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+// 창별 입력 큐. 생산자 = 프레젠터 스레드(이벤트 처리), 소비자 = 유니티 (프레임당 한 번 PollInputEvents)
+// 모션 병합은 꺼내는 쪽에서 함: 연속된 모션은 마지막 것 하나로 합침 (프레젠터가 얼마나 자주 깨어나는지와 무관하게 폴링 한 번 = 모션 하나)
+// 다른 이벤트가 끼어들면 그 앞의 모션은 따로 남아서 순서는 유지됨
+struct InputQueue {
+    SpscRing<InputEvent, 1024> ring;
+    std::atomic<bool> coalesceMotion{ true };
+    std::atomic<unsigned int> dropped{ 0 };
+
+    void Push(const InputEvent& e) {
+        if (!ring.Push(e)) dropped++;
+    }
+    int Drain(InputEvent* out, int maxCount) {
+        bool coalesce = coalesceMotion.load(std::memory_order_relaxed);
+        int n = 0;
+        InputEvent e;
+        while (ring.Peek(e)) {
+            if (coalesce && e.type == INPUT_MOTION && n > 0 && out[n - 1].type == INPUT_MOTION) out[n - 1] = e;
+            else if (n < maxCount) out[n++] = e;
+            else break; // 나머지는 다음 폴링에
+            ring.Pop(e);
+        }
+        return n;
+    }
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include "MultiWindowShared.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <stdio.h>
+
+// 프레임 단계별 트레이스 (Chrome trace / Perfetto JSON)
+// 기록은 스레드별 락프리 링에만 하고, 파일 쓰기는 FlushTrace를 부를 때만 함
+// 꺼져 있을 때 비용은 TraceScope 생성자의 relaxed load 한 번
+
+struct TraceEvent { const char* name; void* handle; long long beginNs; long long endNs; };
+
+struct TraceBuffer {
+    SpscRing<TraceEvent, 8192> ring; // 생산자 = 소유 스레드, 소비자 = FlushTrace
+    std::atomic<bool> inUse{ true };
+    unsigned int threadIndex = 0;
+};
+
+static std::atomic<bool> g_TraceEnabled{ false };
+static std::atomic<unsigned int> g_TraceDropped{ 0 };
+static std::mutex g_TraceMutex; // 버퍼 등록/플러시 전용 (기록 경로에서는 안 잡음)
+static std::vector<TraceBuffer*> g_TraceBuffers; // 스레드가 끝나면 다음 스레드가 재사용
+
+inline long long TraceNowNs() { return MonotonicNowNs(); }
+
+inline TraceBuffer* GetThreadTraceBuffer() {
+    struct Owner { TraceBuffer* buf = nullptr; ~Owner() { if (buf) buf->inUse.store(false, std::memory_order_release); } };
+    thread_local Owner owner;
+    if (owner.buf) return owner.buf;
+
+    std::lock_guard<std::mutex> lock(g_TraceMutex);
+    for (TraceBuffer* b : g_TraceBuffers) {
+        bool expected = false;
+        if (b->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) { owner.buf = b; return b; }
+    }
+    owner.buf = new TraceBuffer();
+    owner.buf->threadIndex = (unsigned int)g_TraceBuffers.size();
+    g_TraceBuffers.push_back(owner.buf);
+    return owner.buf;
+}
+
+inline void TraceRecord(const char* name, void* handle, long long beginNs, long long endNs) {
+    if (!GetThreadTraceBuffer()->ring.Push({ name, handle, beginNs, endNs })) g_TraceDropped++;
+}
+
+// 사용법: { TraceScope trace("Draw", handle); ... }  name은 문자열 리터럴이어야 함
+struct TraceScope {
+    const char* name; void* handle; long long beginNs;
+    TraceScope(const char* n, void* h) : name(n), handle(h), beginNs(g_TraceEnabled.load(std::memory_order_relaxed) ? TraceNowNs() : 0) {}
+    ~TraceScope() { if (beginNs) TraceRecord(name, handle, beginNs, TraceNowNs()); }
+};
+
+// 쌓인 이벤트를 비우면서 파일로 씀. 창 핸들마다 pid 트랙 하나, 그 안에서 스레드별 tid
+// 반환: 쓴 이벤트 수, 파일을 못 열면 -1
+inline int FlushTraceToFile(const char* path) {
+    FILE* f = nullptr;
+#ifdef _WIN32
+    if (fopen_s(&f, path, "w") != 0) f = nullptr;
+#else
+    f = fopen(path, "w");
+#endif
+    if (!f) return -1;
+
+    std::lock_guard<std::mutex> lock(g_TraceMutex);
+    std::vector<void*> tracks;
+    int count = 0;
+    fprintf(f, "{\"traceEvents\":[\n");
+    for (TraceBuffer* b : g_TraceBuffers) {
+        TraceEvent e;
+        while (b->ring.Pop(e)) {
+            bool known = false;
+            for (void* t : tracks) if (t == e.handle) { known = true; break; }
+            if (!known) {
+                tracks.push_back(e.handle);
+                fprintf(f, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%llu,\"args\":{\"name\":\"window %p\"}}",
+                    count ? ",\n" : "", (unsigned long long)(size_t)e.handle, e.handle);
+                count++;
+            }
+            fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%llu,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                e.name, (unsigned long long)(size_t)e.handle, b->threadIndex, e.beginNs / 1000.0, (e.endNs - e.beginNs) / 1000.0);
+            count++;
+        }
+    }
+    fprintf(f, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":%u}}\n", g_TraceDropped.exchange(0));
+    fclose(f);
+    return count - (int)tracks.size();
+}